@@ -1,19 +1,24 @@
-#include <iostream>
-
-#include <client.hpp>
-
-int main(int argc, char** argv) {
-	if (argc != 3) {
-        cerr << "Usage: " << argv[0] << " [address] [port]" << endl;
-        return -1;
-	}
-
-	try {
-		Client client(argv[1], argv[2]);
-		client.run();
-	} catch (const exception& error) {
-		cerr << error.what() << endl;
-	}
-
-	return 0;
-}
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <client.hpp>
+
+int main(int argc, char** argv) {
+	const string unix_option = "--unix=";
+	const auto is_unix = argc == 2 && string(argv[1]).compare(0, unix_option.size(), unix_option) == 0;
+
+	if (argc != 3 && !is_unix) {
+        cerr << "Usage: " << argv[0] << " [address] [port] | " << argv[0] << " --unix=[path]" << endl;
+        return -1;
+	}
+
+	try {
+		unique_ptr<Client> client(is_unix ? new Client(string(argv[1] + unix_option.size())) : new Client(argv[1], argv[2]));
+		client->run();
+	} catch (const exception& error) {
+		cerr << error.what() << endl;
+	}
+
+	return 0;
+}
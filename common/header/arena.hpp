@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Bump allocator for temporaries that all die at the same time, e.g. while handling one message:
+// allocating only moves an offset forward and reset frees everything at once. What does not fit
+// into the block is allocated separately, and the block grows on reset so that it fits next
+// time, so an arena that is reset regularly soon stops allocating at all.
+class Arena {
+private:
+    static constexpr std::size_t min_block_size = 16384;
+
+    std::unique_ptr<unsigned char[]> block;
+    std::size_t block_size;
+    std::size_t offset;
+    std::vector<std::unique_ptr<unsigned char[]>> overflow_blocks;
+    std::size_t overflow_size;
+
+public:
+    Arena();
+    Arena(Arena const &) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Alignment must be a power of two, no larger than alignof(std::max_align_t).
+    void* allocate(const std::size_t size, const std::size_t alignment = alignof(std::max_align_t));
+    // Invalidates everything allocated since the last reset.
+    void reset();
+};
+
+// Lets standard containers allocate from an arena; deallocating does nothing.
+template <typename T>
+class ArenaAllocator {
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Arena* arena;
+
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena& arena) noexcept :
+        arena(&arena)
+    {
+
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept :
+        arena(other.arena)
+    {
+
+    }
+
+    T* allocate(const std::size_t count) {
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* const, const std::size_t) noexcept {
+
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return arena != other.arena;
+    }
+};
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
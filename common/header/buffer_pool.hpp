@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Process wide usage of one size class, summed over the pools of all threads.
+struct BufferPoolClassStats {
+    // Blocks handed out and not yet released.
+    std::atomic<std::uint64_t> in_use;
+    std::atomic<std::uint64_t> high_water;
+};
+
+// Fixed size blocks for I/O buffers, in power of two size classes, so buffers only need to hold
+// one while they have bytes in them. Each thread has its own pool, taking no locks, which keeps
+// a limited number of released blocks per class for reuse; a block released on another thread
+// than the one that acquired it simply moves to that thread's pool.
+class BufferPool {
+public:
+    static constexpr std::size_t min_block_size = 256;
+    static constexpr std::size_t max_block_size = 65536;
+    static constexpr std::size_t class_count = 9;
+
+private:
+    // Released bytes kept per size class, beyond which blocks are freed.
+    static constexpr std::size_t max_free_bytes = 1 << 20;
+
+    static std::array<BufferPoolClassStats, class_count> stats;
+
+    std::array<std::vector<unsigned char*>, class_count> free_blocks;
+
+    BufferPool() noexcept;
+
+    static std::size_t get_class(const std::size_t size) noexcept;
+
+public:
+    ~BufferPool();
+    BufferPool(BufferPool const &) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Returns the calling thread's pool.
+    static BufferPool& get_local();
+    static std::size_t get_block_size(const std::size_t size) noexcept;
+    // Indexed by size class, from min_block_size up.
+    static const std::array<BufferPoolClassStats, class_count>& get_stats() noexcept;
+
+    // Returns a block of at least size bytes, which must not exceed max_block_size.
+    unsigned char* acquire(const std::size_t size);
+    // Takes back a block acquired with the same size.
+    void release(unsigned char* const block, const std::size_t size) noexcept;
+};
+
+// Lets standard containers take their memory from the calling thread's pool, falling back to
+// the heap for more than max_block_size bytes.
+template <typename T>
+class BufferPoolAllocator {
+public:
+    using value_type = T;
+
+    BufferPoolAllocator() noexcept {
+
+    }
+
+    template <typename U>
+    BufferPoolAllocator(const BufferPoolAllocator<U>&) noexcept {
+
+    }
+
+    T* allocate(const std::size_t count) {
+        const auto size = count * sizeof(T);
+
+        if (size > BufferPool::max_block_size) {
+            return static_cast<T*>(::operator new(size));
+        }
+
+        return reinterpret_cast<T*>(BufferPool::get_local().acquire(size));
+    }
+
+    void deallocate(T* const pointer, const std::size_t count) noexcept {
+        const auto size = count * sizeof(T);
+
+        if (size > BufferPool::max_block_size) {
+            ::operator delete(pointer);
+        } else {
+            BufferPool::get_local().release(reinterpret_cast<unsigned char*>(pointer), size);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const BufferPoolAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const BufferPoolAllocator<U>&) const noexcept {
+        return false;
+    }
+};
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
+// Hash table with open addressing in the style of SwissTable: the entries are stored inline in
+// one array, next to an array of one control byte per slot, which is either empty, deleted, or
+// holds 7 bits of the key's hash. Lookups compare the control bytes of a group of 16 slots at a
+// time, with SSE2 on x86-64, and only compare keys whose 7 bits match.
+//
+// Unlike std::unordered_map, inserting may move every entry, so references and iterators are
+// only valid until the next insertion; erasing leaves other entries in place.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap {
+public:
+    using value_type = std::pair<const Key, Value>;
+
+private:
+    using Control = signed char;
+
+    static constexpr Control empty_control = -128;
+    static constexpr Control deleted_control = -2;
+    static constexpr std::size_t group_size = 16;
+    static constexpr std::size_t min_capacity = 16;
+
+    struct Slot {
+        typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage;
+    };
+
+    // The first group_size - 1 control bytes are repeated after the last one, so that a group can
+    // be loaded from any slot without wrapping around. Both arrays are owned, but kept as plain
+    // pointers as they are touched on every lookup, which is slow in unoptimized builds otherwise.
+    Control* controls;
+    Slot* slots;
+    // Zero until the first insertion, then a power of two.
+    std::size_t capacity;
+    std::size_t number_of_entries;
+    // Empty slots that may still be filled before the table has to grow.
+    std::size_t growth_left;
+    Hash hasher;
+
+    // Walks the control bytes and slots side by side, up to the end of the slots.
+    template <bool IsConst>
+    class Iterator {
+    private:
+        friend class FlatHashMap;
+
+        template <bool>
+        friend class Iterator;
+
+        using SlotPointer = typename std::conditional<IsConst, const Slot*, Slot*>::type;
+
+        const Control* control;
+        const Control* end_control;
+        SlotPointer slot;
+
+        Iterator(const Control* const control, const Control* const end_control, const SlotPointer slot) noexcept :
+            control(control),
+            end_control(end_control),
+            slot(slot)
+        {
+
+        }
+
+        void skip_free_slots() noexcept {
+            while (control != end_control && *control < 0) {
+                ++control;
+                ++slot;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::conditional<IsConst, const typename FlatHashMap::value_type, typename FlatHashMap::value_type>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type*;
+        using reference = value_type&;
+
+        Iterator(const Iterator<false>& other) noexcept :
+            control(other.control),
+            end_control(other.end_control),
+            slot(other.slot)
+        {
+
+        }
+
+        reference operator*() const noexcept {
+            return get_value(*slot);
+        }
+
+        pointer operator->() const noexcept {
+            return &get_value(*slot);
+        }
+
+        Iterator& operator++() noexcept {
+            ++control;
+            ++slot;
+            skip_free_slots();
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return control == other.control;
+        }
+
+        bool operator!=(const Iterator& other) const noexcept {
+            return control != other.control;
+        }
+    };
+
+    static value_type& get_value(Slot& slot) noexcept {
+        return *reinterpret_cast<value_type*>(&slot.storage);
+    }
+
+    static const value_type& get_value(const Slot& slot) noexcept {
+        return *reinterpret_cast<const value_type*>(&slot.storage);
+    }
+
+    // Up to 7/8 of the slots are filled before growing.
+    static std::size_t get_max_load(const std::size_t capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+
+    // Bit i is set if the control byte at group + i equals the value.
+    static std::uint32_t match(const Control* const group, const Control value) noexcept {
+#if defined(__x86_64__)
+        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+        std::uint32_t result = 0;
+
+        for (std::size_t i{0}; i < group_size; ++i) {
+            result |= static_cast<std::uint32_t>(group[i] == value) << i;
+        }
+
+        return result;
+#endif
+    }
+
+    // Both empty and deleted are below -1, unlike the hash bits of used slots.
+    static std::uint32_t match_free(const Control* const group) noexcept {
+#if defined(__x86_64__)
+        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), bytes)));
+#else
+        std::uint32_t result = 0;
+
+        for (std::size_t i{0}; i < group_size; ++i) {
+            result |= static_cast<std::uint32_t>(group[i] < -1) << i;
+        }
+
+        return result;
+#endif
+    }
+
+    // Spreads the hash over all bits, as std::hash of an integer is usually the integer itself.
+    // The top 7 bits go into the control byte and the rest select the first group to probe.
+    std::uint64_t get_hash(const Key& key) const noexcept {
+        return static_cast<std::uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    static Control get_control(const std::uint64_t hash) noexcept {
+        return static_cast<Control>(hash >> 57);
+    }
+
+    static std::size_t get_probe_start(const std::uint64_t hash) noexcept {
+        return static_cast<std::size_t>(hash >> 7);
+    }
+
+    void set_control(const std::size_t index, const Control control) noexcept {
+        controls[index] = control;
+
+        if (index < group_size - 1) {
+            controls[capacity + index] = control;
+        }
+    }
+
+    // Probes groups at triangular offsets, which visits every group of a power of two table.
+    std::size_t find_index(const Key& key, const std::uint64_t hash) const noexcept {
+        if (capacity == 0) {
+            return capacity;
+        }
+
+        const auto mask = capacity - 1;
+        const auto control = get_control(hash);
+        auto offset = get_probe_start(hash) & mask;
+
+        for (std::size_t step = group_size;; step += group_size) {
+            const auto group = controls + offset;
+
+            for (auto matches = match(group, control); matches != 0; matches &= matches - 1) {
+                const auto index = (offset + __builtin_ctz(matches)) & mask;
+
+                if (get_value(slots[index]).first == key) {
+                    return index;
+                }
+            }
+
+            if (match(group, empty_control) != 0) {
+                return capacity;
+            }
+
+            offset = (offset + step) & mask;
+        }
+    }
+
+    std::size_t find_free_index(const std::uint64_t hash) const noexcept {
+        const auto mask = capacity - 1;
+        auto offset = get_probe_start(hash) & mask;
+
+        for (std::size_t step = group_size;; step += group_size) {
+            const auto matches = match_free(controls + offset);
+
+            if (matches != 0) {
+                return (offset + __builtin_ctz(matches)) & mask;
+            }
+
+            offset = (offset + step) & mask;
+        }
+    }
+
+    // Grows the table, or only clears out deleted slots if they make up most of the load.
+    void rehash() {
+        auto new_capacity = capacity == 0 ? min_capacity : capacity;
+
+        if (number_of_entries * 2 >= get_max_load(new_capacity)) {
+            new_capacity *= 2;
+        }
+
+        std::unique_ptr<Control[]> new_controls(new Control[new_capacity + group_size - 1]);
+        std::unique_ptr<Slot[]> new_slots(new Slot[new_capacity]);
+        std::unique_ptr<Control[]> old_controls(controls);
+        std::unique_ptr<Slot[]> old_slots(slots);
+        const auto old_capacity = capacity;
+        controls = new_controls.release();
+        slots = new_slots.release();
+        capacity = new_capacity;
+        growth_left = get_max_load(capacity) - number_of_entries;
+
+        for (std::size_t i{0}; i < capacity + group_size - 1; ++i) {
+            controls[i] = empty_control;
+        }
+
+        for (std::size_t i{0}; i < old_capacity; ++i) {
+            if (old_controls[i] < 0) {
+                continue;
+            }
+
+            auto& value = get_value(old_slots[i]);
+            const auto hash = get_hash(value.first);
+            const auto index = find_free_index(hash);
+            new (&slots[index].storage) value_type(std::move(value));
+            set_control(index, get_control(hash));
+            value.~value_type();
+        }
+    }
+
+    template <typename Result, typename Map>
+    static Result get_iterator(Map& map, const std::size_t index) noexcept {
+        return Result(map.controls + index, map.controls + map.capacity, map.slots + index);
+    }
+
+    // A slot can only be marked empty again if no probe went past it, i.e. it was never inside a
+    // run of group_size used or deleted slots.
+    void erase_index(const std::size_t index) noexcept {
+        assert(index < capacity && controls[index] >= 0);
+
+        get_value(slots[index]).~value_type();
+        --number_of_entries;
+
+        const auto empty_before = match(controls + ((index - group_size) & (capacity - 1)), empty_control);
+        const auto empty_after = match(controls + index, empty_control);
+
+        if (empty_before != 0 && empty_after != 0 && static_cast<std::size_t>(__builtin_ctz(empty_after) + __builtin_clz(empty_before) - 16) < group_size) {
+            set_control(index, empty_control);
+            ++growth_left;
+        } else {
+            set_control(index, deleted_control);
+        }
+    }
+
+    void destroy() noexcept {
+        for (auto iterator = begin(); iterator != end(); ++iterator) {
+            iterator->~value_type();
+        }
+    }
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() :
+        controls(nullptr),
+        slots(nullptr),
+        capacity(0),
+        number_of_entries(0),
+        growth_left(0),
+        hasher()
+    {
+
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept :
+        controls(other.controls),
+        slots(other.slots),
+        capacity(other.capacity),
+        number_of_entries(other.number_of_entries),
+        growth_left(other.growth_left),
+        hasher(std::move(other.hasher))
+    {
+        other.controls = nullptr;
+        other.slots = nullptr;
+        other.capacity = 0;
+        other.number_of_entries = 0;
+        other.growth_left = 0;
+    }
+
+    ~FlatHashMap() {
+        destroy();
+        delete[] controls;
+        delete[] slots;
+    }
+
+    FlatHashMap(FlatHashMap const &) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+        std::swap(controls, other.controls);
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(number_of_entries, other.number_of_entries);
+        std::swap(growth_left, other.growth_left);
+        std::swap(hasher, other.hasher);
+        return *this;
+    }
+
+    Value& operator[](const Key& key) {
+        return emplace(key).first->second;
+    }
+
+    iterator begin() noexcept {
+        auto result = get_iterator<iterator>(*this, 0);
+        result.skip_free_slots();
+        return result;
+    }
+
+    const_iterator begin() const noexcept {
+        auto result = get_iterator<const_iterator>(*this, 0);
+        result.skip_free_slots();
+        return result;
+    }
+
+    void clear() noexcept {
+        destroy();
+
+        if (capacity > 0) {
+            for (std::size_t i{0}; i < capacity + group_size - 1; ++i) {
+                controls[i] = empty_control;
+            }
+
+            growth_left = get_max_load(capacity);
+        }
+
+        number_of_entries = 0;
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(const Key& key, Args&&... args) {
+        const auto hash = get_hash(key);
+        const auto found_index = find_index(key, hash);
+
+        if (found_index != capacity) {
+            return std::make_pair(get_iterator<iterator>(*this, found_index), false);
+        }
+
+        auto index = capacity == 0 ? 0 : find_free_index(hash);
+
+        // Deleted slots can be reused without using up the room for growth.
+        if (capacity == 0 || (growth_left == 0 && controls[index] == empty_control)) {
+            rehash();
+            index = find_free_index(hash);
+        }
+
+        new (&slots[index].storage) value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        growth_left -= controls[index] == empty_control;
+        set_control(index, get_control(hash));
+        ++number_of_entries;
+
+        return std::make_pair(get_iterator<iterator>(*this, index), true);
+    }
+
+    bool empty() const noexcept {
+        return number_of_entries == 0;
+    }
+
+    iterator end() noexcept {
+        return get_iterator<iterator>(*this, capacity);
+    }
+
+    const_iterator end() const noexcept {
+        return get_iterator<const_iterator>(*this, capacity);
+    }
+
+    void erase(const const_iterator position) noexcept {
+        erase_index(static_cast<std::size_t>(position.control - controls));
+    }
+
+    std::size_t erase(const Key& key) noexcept {
+        const auto index = find_index(key, get_hash(key));
+
+        if (index == capacity) {
+            return 0;
+        }
+
+        erase_index(index);
+        return 1;
+    }
+
+    iterator find(const Key& key) noexcept {
+        return get_iterator<iterator>(*this, find_index(key, get_hash(key)));
+    }
+
+    const_iterator find(const Key& key) const noexcept {
+        return get_iterator<const_iterator>(*this, find_index(key, get_hash(key)));
+    }
+
+    std::size_t size() const noexcept {
+        return number_of_entries;
+    }
+};
+
+template <typename Key, typename Value, typename Hash>
+constexpr typename FlatHashMap<Key, Value, Hash>::Control FlatHashMap<Key, Value, Hash>::empty_control;
+
+template <typename Key, typename Value, typename Hash>
+constexpr typename FlatHashMap<Key, Value, Hash>::Control FlatHashMap<Key, Value, Hash>::deleted_control;
+
+template <typename Key, typename Value, typename Hash>
+constexpr std::size_t FlatHashMap<Key, Value, Hash>::group_size;
+
+template <typename Key, typename Value, typename Hash>
+constexpr std::size_t FlatHashMap<Key, Value, Hash>::min_capacity;
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+#include <string_view.hpp>
+
+namespace protocol {
+    // A name of up to Capacity letters and digits, held in the bytes of a single 64-bit word and
+    // padded with zeros, so that comparing or hashing two names is one integer operation. As the
+    // bytes keep their order in memory, the name can still be viewed as characters.
+    template <std::size_t Capacity>
+    class PackedName {
+    private:
+        static_assert(Capacity > 0 && Capacity <= sizeof(std::uint64_t), "A packed name must fit into 64 bits");
+
+        static constexpr std::uint64_t low_bits = 0x0101010101010101ULL;
+
+        std::uint64_t value;
+
+        explicit PackedName(const std::uint64_t value) noexcept :
+            value(value)
+        {
+
+        }
+
+    public:
+        static constexpr std::size_t capacity = Capacity;
+
+        PackedName() noexcept :
+            value(0)
+        {
+
+        }
+
+        // The name must already have been validated.
+        explicit PackedName(const StringView name) noexcept :
+            value(0)
+        {
+            assert(name.size() <= Capacity);
+            memcpy(&value, name.data(), name.size() < Capacity ? name.size() : Capacity);
+        }
+
+        // Letters are the only bytes with 0x40 set, and their lowercase form also has 0x20 set,
+        // which digits already do.
+        PackedName fold_case() const noexcept {
+            return PackedName(value | ((value & (low_bits * 0x40)) >> 1));
+        }
+
+        std::uint64_t get_value() const noexcept {
+            return value;
+        }
+
+        // Sets the top bit of every non-zero byte and counts them.
+        std::size_t size() const noexcept {
+            const auto high_bits = low_bits * 0x80;
+            const auto low_seven_bits = low_bits * 0x7F;
+            return static_cast<std::size_t>(__builtin_popcountll((((value & low_seven_bits) + low_seven_bits) | value) & high_bits));
+        }
+
+        // Views the characters of this object, so it must outlive the view.
+        StringView view() const noexcept {
+            return StringView(reinterpret_cast<const char*>(&value), size());
+        }
+    };
+
+    template <std::size_t Capacity>
+    constexpr std::size_t PackedName<Capacity>::capacity;
+
+    template <std::size_t Capacity>
+    constexpr std::uint64_t PackedName<Capacity>::low_bits;
+
+    template <std::size_t Capacity>
+    inline bool operator==(const PackedName<Capacity> left, const PackedName<Capacity> right) noexcept {
+        return left.get_value() == right.get_value();
+    }
+
+    template <std::size_t Capacity>
+    inline bool operator!=(const PackedName<Capacity> left, const PackedName<Capacity> right) noexcept {
+        return left.get_value() != right.get_value();
+    }
+
+    template <std::size_t Capacity>
+    inline bool equals_ignore_case(const PackedName<Capacity> left, const PackedName<Capacity> right) noexcept {
+        return left.fold_case() == right.fold_case();
+    }
+
+    // User names are 4 to 8 letters and digits.
+    using UserName = PackedName<8>;
+}
+
+namespace std {
+    // Multiplies by 2^64 over the golden ratio into 128 bits and folds the high half into the low
+    // one. Every bit of the high half depends on every byte of the name, so names which only
+    // differ in their last characters still spread over the low bits.
+    template <size_t Capacity>
+    struct hash<protocol::PackedName<Capacity>> {
+        size_t operator()(const protocol::PackedName<Capacity> name) const noexcept {
+            const auto result = static_cast<unsigned __int128>(name.get_value()) * 0x9E3779B97F4A7C15ULL;
+            return static_cast<size_t>(result ^ (result >> 64));
+        }
+    };
+}
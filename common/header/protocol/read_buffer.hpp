@@ -1,105 +1,213 @@
-#pragma once
-
-#include <array>
-#include <cassert>
-#include <cstddef>
-#include <exception>
-
-#include <arpa/inet.h>
-
-#include <protocol/message.hpp>
-#include <socket/tcp_client_socket.hpp>
-
-namespace protocol {
-    class InvalidReadException : public std::exception {
-    public:
-        const char* what() const noexcept override;
-    };
-
-    class SocketClosedException : public std::exception {
-    public:
-        const char* what() const noexcept override;
-    };
-
-    template <std::size_t BufferSize>
-    class ReadBuffer {
-    private:
-        std::array<unsigned char, BufferSize> buffer;
-        std::size_t bytes_processed;
-        std::size_t bytes_read;
-        std::size_t bytes_remaining;
-
-    public:
-        bool is_ready() const noexcept {
-            return bytes_remaining == 0;
-        }
-
-        void read_from_socket(TCPClientSocket& socket) {
-            if (is_ready()) {
-                return;
-            }
-
-            const auto original_remaining = bytes_remaining;
-            auto helper = [=]() {
-                bytes_read += original_remaining - bytes_remaining;
-            };
-
-            try {
-                if (socket.recv(buffer.data() + bytes_read, bytes_remaining)) {
-                    throw SocketClosedException();
-                }
-            } catch (...) {
-                helper();
-                throw;
-            }
-
-            helper();
-        }
-
-        unsigned char read_u8() {
-            unsigned char u8;
-            
-            if (!try_read_u8(u8)) {
-                throw InvalidReadException();
-            }
-            
-            return u8;
-        }
-
-        unsigned short read_u16() {
-            unsigned short u16;
-
-            if (!try_read_u16(u16)) {
-                throw InvalidReadException();
-            }
-            
-            return u16;
-        }
-
-        void reset(const std::size_t size) noexcept {
-            bytes_processed = 0;
-            bytes_read = 0;
-            bytes_remaining = size;
-        }
-
-        bool try_read_u8(unsigned char& u8) {
-            if (bytes_processed + 1 > bytes_read) {
-                return false;
-            }
-
-            u8 = buffer[bytes_processed];
-            ++bytes_processed;
-            return true;
-        }
-
-        bool try_read_u16(unsigned short& u16) {
-            if (bytes_processed + 2 > bytes_read) {
-                return false;
-            }
-
-            u16 = ntohs(buffer[bytes_processed + 1] << 8 | buffer[bytes_processed]);
-            bytes_processed += 2;
-            return true;
-        }
-    };
-}
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+
+#include <arpa/inet.h>
+
+#include <buffer_pool.hpp>
+#include <protocol/message.hpp>
+#include <socket/tcp_client_socket.hpp>
+#include <string_view.hpp>
+
+namespace protocol {
+    class InvalidReadException : public std::exception {
+    public:
+        const char* what() const noexcept override;
+    };
+
+    // Receives as much as is available into a linear buffer and hands it out one frame at a time:
+    // reset starts the next frame of the given size right after the current one, and the frame is
+    // ready once all of its bytes have been received. Bytes of a partial frame are moved back to
+    // the start of the buffer before receiving more, so a frame of up to BufferSize bytes fits.
+    // The memory is borrowed from the thread's BufferPool while any bytes are buffered, so an
+    // idle connection holds none.
+    template <std::size_t BufferSize>
+    class ReadBuffer {
+    private:
+        unsigned char* buffer;
+        // Start of the current frame and end of the received bytes.
+        std::size_t begin;
+        std::size_t end;
+        std::size_t frame_size;
+        std::size_t bytes_processed;
+
+        void attach() {
+            if (buffer == nullptr) {
+                buffer = BufferPool::get_local().acquire(BufferSize);
+            }
+        }
+
+        void compact() noexcept {
+            if (begin == 0) {
+                return;
+            }
+
+            memmove(buffer, buffer + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+
+        void detach() noexcept {
+            if (buffer != nullptr) {
+                BufferPool::get_local().release(buffer, BufferSize);
+                buffer = nullptr;
+            }
+        }
+
+    public:
+        ReadBuffer() noexcept :
+            buffer(nullptr),
+            begin(0),
+            end(0),
+            frame_size(0),
+            bytes_processed(0)
+        {
+
+        }
+
+        ReadBuffer(const ReadBuffer&) = delete;
+
+        ReadBuffer(ReadBuffer&& other) noexcept :
+            buffer(other.buffer),
+            begin(other.begin),
+            end(other.end),
+            frame_size(other.frame_size),
+            bytes_processed(other.bytes_processed)
+        {
+            other.buffer = nullptr;
+            other.begin = 0;
+            other.end = 0;
+        }
+
+        ~ReadBuffer() {
+            detach();
+        }
+
+        ReadBuffer& operator=(const ReadBuffer&) = delete;
+        ReadBuffer& operator=(ReadBuffer&&) = delete;
+
+        // Returns the number of bytes of the current frame received so far.
+        std::size_t get_bytes_read() const noexcept {
+            return end - begin < frame_size ? end - begin : frame_size;
+        }
+
+        bool is_ready() const noexcept {
+            return end - begin >= frame_size;
+        }
+
+        // Receives with a single call and sets is_filled to whether the buffer was filled, in which
+        // case more data may be waiting; a short read means the socket had nothing more to give.
+        IoResult read_from_socket(TCPClientSocket& socket, bool& is_filled) {
+            if (is_ready()) {
+                is_filled = true;
+                return IoResult{IoStatus::Complete, 0, 0};
+            }
+
+            attach();
+            compact();
+
+            const auto free_size = BufferSize - end;
+            const auto result = socket.try_recv(buffer + end, free_size);
+            end += result.bytes;
+            is_filled = result.bytes == free_size;
+
+            if (end == 0) {
+                detach();
+            }
+
+            return result;
+        }
+
+        std::size_t read_from_memory(const unsigned char* const data, const std::size_t size) {
+            if (size == 0) {
+                return 0;
+            }
+
+            attach();
+            compact();
+
+            const auto free_size = BufferSize - end;
+            const auto bytes_copied = size < free_size ? size : free_size;
+            assert(bytes_copied > 0 || size == 0 || is_ready());
+            memcpy(buffer + end, data, bytes_copied);
+
+            end += bytes_copied;
+            return bytes_copied;
+        }
+
+        unsigned char read_u8() {
+            unsigned char u8;
+            
+            if (!try_read_u8(u8)) {
+                throw InvalidReadException();
+            }
+            
+            return u8;
+        }
+
+        unsigned short read_u16() {
+            unsigned short u16;
+
+            if (!try_read_u16(u16)) {
+                throw InvalidReadException();
+            }
+            
+            return u16;
+        }
+
+        // Reads a field of up to size bytes in place, or what is left of the frame if that is less.
+        // The view points into the buffer and is only valid until the next reset.
+        StringView read_string(const std::size_t size) noexcept {
+            const auto string_size = std::min(size, get_bytes_read() - bytes_processed);
+
+            if (string_size == 0) {
+                return StringView();
+            }
+
+            const StringView string(reinterpret_cast<const char*>(buffer) + begin + bytes_processed, string_size);
+            bytes_processed += string_size;
+
+            return string;
+        }
+
+        // Discards the current frame, whether or not all of it was read, and starts the next one.
+        void reset(const std::size_t size) noexcept {
+            assert(size <= BufferSize);
+
+            begin += get_bytes_read();
+
+            if (begin == end) {
+                begin = 0;
+                end = 0;
+                detach();
+            }
+
+            frame_size = size;
+            bytes_processed = 0;
+        }
+
+        bool try_read_u8(unsigned char& u8) {
+            if (bytes_processed + 1 > get_bytes_read()) {
+                return false;
+            }
+
+            u8 = buffer[begin + bytes_processed];
+            ++bytes_processed;
+            return true;
+        }
+
+        bool try_read_u16(unsigned short& u16) {
+            if (bytes_processed + 2 > get_bytes_read()) {
+                return false;
+            }
+
+            u16 = ntohs(buffer[begin + bytes_processed + 1] << 8 | buffer[begin + bytes_processed]);
+            bytes_processed += 2;
+            return true;
+        }
+    };
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+namespace protocol {
+    // Validators for the character classes of the protocol, independent of the locale: names and
+    // passwords are ASCII letters and digits, messages printable ASCII (0x20 to 0x7E). Both return
+    // the offset of the first byte outside the class, or size if there is none, and check 32 or
+    // 16 bytes at a time with AVX2 or SSE2 where the CPU supports it.
+
+    std::size_t find_non_alnum(const char* const data, const std::size_t size) noexcept;
+    std::size_t find_non_printable(const char* const data, const std::size_t size) noexcept;
+
+    // The implementations the validators choose from, so that tests and benchmarks can run each of
+    // them. A kernel has to be supported by the CPU to be passed to the overloads below.
+    enum class ValidationKernel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    bool is_supported(const ValidationKernel kernel) noexcept;
+    std::size_t find_non_alnum(const char* const data, const std::size_t size, const ValidationKernel kernel) noexcept;
+    std::size_t find_non_printable(const char* const data, const std::size_t size, const ValidationKernel kernel) noexcept;
+}
@@ -1,89 +1,242 @@
-#pragma once
-
-#include <array>
-#include <cstddef>
-#include <exception>
-
-#include <arpa/inet.h>
-
-#include <socket/tcp_client_socket.hpp>
-#include <iostream>
-namespace protocol {
-    class WriteBufferFullException : public std::exception {
-    private:
-        const std::size_t bytes_written;
-
-    public:
-        WriteBufferFullException(const std::size_t write_count) noexcept;
-
-        std::size_t get_bytes_written() const noexcept;
-        const char* what() const noexcept override;
-    };
-
-    template <std::size_t BufferSize>
-    class WriteBuffer {
-    private:
-        std::array<unsigned char, BufferSize> buffer;
-        std::size_t buffer_head;
-        std::size_t buffer_tail;
-        std::size_t bytes_written;
-
-    public:
-        bool is_empty() const noexcept {
-            return buffer_head == buffer_tail;
-        }
-
-        bool is_full() const noexcept {
-            return (buffer_head + 1) % BufferSize == buffer_tail;
-        }
-
-        void write_to_socket(TCPClientSocket& socket) {
-            if (is_empty()) {
-                return;
-            }
-
-            auto size = buffer_head > buffer_tail ?
-                        buffer_head - buffer_tail :
-                        BufferSize - buffer_tail;
-            const auto original_size = size;
-            auto helper = [&]() {
-                auto bytes_written = original_size - size;
-                buffer_tail += bytes_written;
-            
-                if (buffer_tail == BufferSize) {
-                    buffer_tail = 0;
-                }
-            };
-    
-            try {
-                socket.send(buffer.data() + buffer_tail, size);
-            } catch (...) {
-                helper();
-                throw;
-            }
-    
-            helper();
-        }
-
-        void write_u8(const unsigned char u8) {
-            if (is_full()) {
-                const auto bytes_written = this->bytes_written;
-                this->bytes_written = 0;
-                throw WriteBufferFullException(bytes_written);
-            }
-    
-            buffer[buffer_head] = u8;
-            buffer_head = (buffer_head + 1) % BufferSize;
-        }
-
-        void write_u16(unsigned short u16) {
-            u16 = htons(u16);
-    
-            bytes_written = 0;
-            write_u8(u16 & 0xFF);
-    
-            ++bytes_written;
-            write_u8(u16 >> 8);
-        }
-    };
-}
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#include <arpa/inet.h>
+#include <sys/uio.h>
+
+#include <buffer_pool.hpp>
+#include <protocol/message.hpp>
+#include <socket/tcp_client_socket.hpp>
+#include <iostream>
+namespace protocol {
+    class WriteBufferFullException : public std::exception {
+    private:
+        const std::size_t bytes_written;
+
+    public:
+        WriteBufferFullException(const std::size_t write_count) noexcept;
+
+        std::size_t get_bytes_written() const noexcept;
+        const char* what() const noexcept override;
+    };
+
+    // Helpers to encode a payload for write_frame, in network byte order like write_u16.
+
+    template <typename Traits, typename Allocator>
+    void append_u8(std::basic_string<char, Traits, Allocator>& payload, const unsigned char u8) {
+        payload += static_cast<char>(u8);
+    }
+
+    template <typename Traits, typename Allocator>
+    void append_u16(std::basic_string<char, Traits, Allocator>& payload, const unsigned short u16) {
+        payload += static_cast<char>(u16 >> 8);
+        payload += static_cast<char>(u16 & 0xFF);
+    }
+
+    // Ring buffer of outgoing bytes. BufferSize must be a power of two so positions wrap with a
+    // mask, and one byte is kept free to tell a full buffer from an empty one. Like ReadBuffer, it
+    // borrows its memory from the thread's BufferPool only while it holds any bytes.
+    template <std::size_t BufferSize>
+    class WriteBuffer {
+    private:
+        static_assert(BufferSize > 1 && (BufferSize & (BufferSize - 1)) == 0, "BufferSize must be a power of two");
+
+        static constexpr std::size_t mask = BufferSize - 1;
+
+        unsigned char* buffer;
+        std::size_t buffer_head;
+        std::size_t buffer_tail;
+        std::size_t bytes_written;
+
+        void attach() {
+            if (buffer == nullptr) {
+                buffer = BufferPool::get_local().acquire(BufferSize);
+            }
+        }
+
+        // Copies in at most two contiguous runs; the data must fit into the free space.
+        void copy_in(const unsigned char* const data, const std::size_t size) {
+            if (size == 0) {
+                return;
+            }
+
+            attach();
+
+            const auto first_size = std::min(size, BufferSize - buffer_head);
+            memcpy(buffer + buffer_head, data, first_size);
+            memcpy(buffer, data + first_size, size - first_size);
+            buffer_head = (buffer_head + size) & mask;
+        }
+
+        void detach() noexcept {
+            if (buffer != nullptr) {
+                BufferPool::get_local().release(buffer, BufferSize);
+                buffer = nullptr;
+            }
+        }
+
+    public:
+        WriteBuffer() noexcept :
+            buffer(nullptr),
+            buffer_head(0),
+            buffer_tail(0),
+            bytes_written(0)
+        {
+
+        }
+
+        WriteBuffer(const WriteBuffer&) = delete;
+
+        WriteBuffer(WriteBuffer&& other) noexcept :
+            buffer(other.buffer),
+            buffer_head(other.buffer_head),
+            buffer_tail(other.buffer_tail),
+            bytes_written(other.bytes_written)
+        {
+            other.buffer = nullptr;
+            other.buffer_head = 0;
+            other.buffer_tail = 0;
+        }
+
+        ~WriteBuffer() {
+            detach();
+        }
+
+        WriteBuffer& operator=(const WriteBuffer&) = delete;
+        WriteBuffer& operator=(WriteBuffer&&) = delete;
+
+        // The memory goes back to the pool once everything has been consumed, so pointers handed
+        // out by peek stay valid until then.
+        void consume(const std::size_t size) noexcept {
+            buffer_tail = (buffer_tail + size) & mask;
+
+            if (buffer_head == buffer_tail) {
+                buffer_head = 0;
+                buffer_tail = 0;
+                detach();
+            }
+        }
+
+        std::size_t get_free_size() const noexcept {
+            return mask - get_size();
+        }
+
+        std::size_t get_size() const noexcept {
+            return (buffer_head - buffer_tail) & mask;
+        }
+
+        bool is_empty() const noexcept {
+            return buffer_head == buffer_tail;
+        }
+
+        bool is_full() const noexcept {
+            return ((buffer_head + 1) & mask) == buffer_tail;
+        }
+
+        // Returns the contiguous run of bytes at the front of the buffer.
+        std::size_t peek(const unsigned char*& data) const noexcept {
+            data = buffer + buffer_tail;
+
+            return buffer_head >= buffer_tail ?
+                   buffer_head - buffer_tail :
+                   BufferSize - buffer_tail;
+        }
+
+        // Fills in a vector for each run of bytes, two if the buffer wraps, and returns how many.
+        std::size_t peek(iovec* const vectors) const noexcept {
+            if (is_empty()) {
+                return 0;
+            }
+
+            const unsigned char* data;
+            vectors[0].iov_len = peek(data);
+            vectors[0].iov_base = const_cast<unsigned char*>(data);
+
+            if (buffer_head >= buffer_tail || buffer_head == 0) {
+                return 1;
+            }
+
+            vectors[1].iov_base = buffer;
+            vectors[1].iov_len = buffer_head;
+            return 2;
+        }
+
+        // Sends both runs of a wrapped buffer with a single writev.
+        IoResult write_to_socket(TCPClientSocket& socket) {
+            iovec vectors[2];
+            const auto count = peek(vectors);
+
+            if (count == 0) {
+                return IoResult{IoStatus::Complete, 0, 0};
+            }
+
+            const auto result = socket.try_send(vectors, count);
+            consume(result.bytes);
+
+            return result;
+        }
+
+        // Writes all of the data or, if it does not fit, throws WriteBufferFullException without
+        // writing anything.
+        void write_bytes(const unsigned char* const data, const std::size_t size) {
+            if (size > get_free_size()) {
+                throw WriteBufferFullException(0);
+            }
+
+            copy_in(data, size);
+        }
+
+        void write_frame(const unsigned char message_type, const std::string& payload) {
+            write_frame(message_type, reinterpret_cast<const unsigned char*>(payload.data()), payload.size());
+        }
+
+        // Writes a message header followed by its payload, all or nothing like write_bytes.
+        void write_frame(const unsigned char message_type, const unsigned char* const payload, const std::size_t size) {
+            assert(size <= 0xFFFF);
+
+            if (header_size + size > get_free_size()) {
+                throw WriteBufferFullException(0);
+            }
+
+            const unsigned char header[header_size] = {
+                message_type,
+                static_cast<unsigned char>(size >> 8),
+                static_cast<unsigned char>(size & 0xFF)
+            };
+
+            copy_in(header, header_size);
+            copy_in(payload, size);
+        }
+
+        void write_u8(const unsigned char u8) {
+            if (is_full()) {
+                const auto bytes_written = this->bytes_written;
+                this->bytes_written = 0;
+                throw WriteBufferFullException(bytes_written);
+            }
+
+            attach();
+            buffer[buffer_head] = u8;
+            buffer_head = (buffer_head + 1) & mask;
+        }
+
+        void write_u16(unsigned short u16) {
+            u16 = htons(u16);
+    
+            bytes_written = 0;
+            write_u8(u16 & 0xFF);
+    
+            ++bytes_written;
+            write_u8(u16 >> 8);
+        }
+    };
+
+    template <std::size_t BufferSize>
+    constexpr std::size_t WriteBuffer<BufferSize>::mask;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+void format_address(const sockaddr_storage& address, const socklen_t address_size, std::string& ip_address, std::string& port);
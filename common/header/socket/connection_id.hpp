@@ -0,0 +1,5 @@
+#pragma once
+
+#include <cstddef>
+
+using ConnectionID = std::size_t;
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Small integer handle of a slot in a ConnectionPool. Handles of removed connections are reused.
+using ConnectionHandle = std::uint32_t;
+
+// Slab of connection slots allocated in fixed-size chunks. A connection is constructed in place
+// and keeps its address until it is erased, and freed slots are reused (most recently freed
+// first) without allocating or moving other connections.
+template <typename T>
+class ConnectionPool {
+private:
+    static constexpr std::size_t slots_per_chunk = 32;
+
+    struct Slot {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        ConnectionHandle next_free;
+        bool is_used;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    ConnectionHandle free_handle;
+    std::size_t number_of_slots;
+    std::size_t number_of_used_slots;
+
+    Slot& get_slot(const ConnectionHandle handle) const noexcept {
+        assert(handle < number_of_slots);
+
+        return chunks[handle / slots_per_chunk][handle % slots_per_chunk];
+    }
+
+    static T& get_value(Slot& slot) noexcept {
+        return *reinterpret_cast<T*>(&slot.storage);
+    }
+
+    ConnectionHandle allocate() {
+        if (free_handle != invalid_handle) {
+            const auto handle = free_handle;
+            free_handle = get_slot(handle).next_free;
+            return handle;
+        }
+
+        if (number_of_slots == chunks.size() * slots_per_chunk) {
+            assert(number_of_slots + slots_per_chunk < invalid_handle);
+
+            std::unique_ptr<Slot[]> chunk(new Slot[slots_per_chunk]);
+
+            for (std::size_t i{0}; i < slots_per_chunk; ++i) {
+                chunk[i].is_used = false;
+            }
+
+            chunks.push_back(std::move(chunk));
+        }
+
+        return static_cast<ConnectionHandle>(number_of_slots++);
+    }
+
+    void release(const ConnectionHandle handle) noexcept {
+        auto& slot = get_slot(handle);
+        slot.is_used = false;
+        slot.next_free = free_handle;
+        free_handle = handle;
+    }
+
+public:
+    static constexpr ConnectionHandle invalid_handle = std::numeric_limits<ConnectionHandle>::max();
+
+    ConnectionPool() :
+        chunks(),
+        free_handle(invalid_handle),
+        number_of_slots(0),
+        number_of_used_slots(0)
+    {
+
+    }
+
+    ~ConnectionPool() {
+        clear();
+    }
+
+    ConnectionPool(ConnectionPool const &) = delete;
+    ConnectionPool(ConnectionPool&&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(ConnectionPool&&) = delete;
+
+    template <typename Predicate>
+    bool any_of(Predicate&& predicate) const {
+        for (std::size_t i{0}; i < number_of_slots; ++i) {
+            auto& slot = get_slot(static_cast<ConnectionHandle>(i));
+
+            if (slot.is_used && predicate(get_value(slot))) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    T& operator[](const ConnectionHandle handle) const noexcept {
+        assert(get_slot(handle).is_used);
+
+        return get_value(get_slot(handle));
+    }
+
+    void clear() noexcept {
+        for (std::size_t i{0}; i < number_of_slots; ++i) {
+            auto& slot = get_slot(static_cast<ConnectionHandle>(i));
+
+            if (slot.is_used) {
+                erase(static_cast<ConnectionHandle>(i));
+            }
+        }
+    }
+
+    template <typename... Args>
+    ConnectionHandle emplace(Args&&... args) {
+        const auto handle = allocate();
+        auto& slot = get_slot(handle);
+
+        try {
+            new (&slot.storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            release(handle);
+            throw;
+        }
+
+        slot.is_used = true;
+        ++number_of_used_slots;
+
+        return handle;
+    }
+
+    void erase(const ConnectionHandle handle) noexcept {
+        auto& slot = get_slot(handle);
+        assert(slot.is_used);
+
+        get_value(slot).~T();
+        release(handle);
+        --number_of_used_slots;
+    }
+
+    // Returns nullptr if the handle is out of range or its slot is free, so handles kept past the
+    // lifetime of their connection can be checked safely.
+    T* find(const ConnectionHandle handle) const noexcept {
+        if (handle >= number_of_slots) {
+            return nullptr;
+        }
+
+        auto& slot = get_slot(handle);
+
+        return slot.is_used ? &get_value(slot) : nullptr;
+    }
+
+    std::size_t size() const noexcept {
+        return number_of_used_slots;
+    }
+};
+
+template <typename T>
+constexpr std::size_t ConnectionPool<T>::slots_per_chunk;
+
+template <typename T>
+constexpr ConnectionHandle ConnectionPool<T>::invalid_handle;
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <exception>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <exception.hpp>
+#include <socket/connection_id.hpp>
+#include <socket/connection_pool.hpp>
+#include <socket/event_fd.hpp>
+#include <socket/tcp_client_socket.hpp>
+#include <timer_wheel.hpp>
+
+// Edge-triggered epoll(7) backend with the same interface as PollData. Only the connections
+// reported ready are visited, and each epoll_event carries the pool handle of its connection (the
+// listening sockets and the wakeup eventfd are registered with values outside the range of
+// handles).
+template <typename TConnection>
+class EpollData {
+private:
+    static constexpr std::size_t max_accepts_per_poll = 64;
+    static constexpr int max_events = 256;
+    static constexpr std::uint64_t listen_event_data = std::uint64_t{1} << 32;
+    static constexpr std::uint64_t wakeup_event_data = std::numeric_limits<std::uint64_t>::max();
+
+    ConnectionID connection_sequence_number;
+    int epoll_fd;
+    std::vector<int> listen_fds;
+    // Cleared while at the maximum number of connections, with the listening sockets disarmed.
+    bool is_accepting;
+    std::size_t max_connections;
+    ConnectionPool<TConnection> connections;
+    std::vector<epoll_event> events;
+    TimerWheel timers;
+    EventFD* wakeup_event;
+    std::vector<ConnectionHandle> write_pending_handles;
+
+    static short to_poll_events(const uint32_t epoll_events) noexcept {
+        short events = 0;
+
+        if (epoll_events & EPOLLIN) {
+            events |= POLLRDNORM;
+        }
+
+        if (epoll_events & EPOLLOUT) {
+            events |= POLLWRNORM;
+        }
+
+        if (epoll_events & EPOLLERR) {
+            events |= POLLERR;
+        }
+
+        if (epoll_events & (EPOLLHUP | EPOLLRDHUP)) {
+            events |= POLLHUP;
+        }
+
+        return events;
+    }
+
+    template <typename AddConnectionLambda>
+    void accept_connections(const int listen_fd, const TimerWheel::Clock::time_point now, AddConnectionLambda&& add_connection_lambda) {
+        // Accepts are capped per wakeup so a connect storm cannot starve established connections;
+        // the level-triggered listening socket reports the rest of the backlog on the next wait.
+        for (std::size_t i{0}; i < max_accepts_per_poll; ++i) {
+            if (connections.size() >= max_connections) {
+                if (is_accepting) {
+                    std::cerr << "Not accepting further connections until one is closed, as the maximum has been reached." << std::endl;
+                    set_accepting(false);
+                }
+
+                return;
+            }
+
+            sockaddr_storage address;
+            socklen_t address_size = sizeof(address);
+            const auto fd = accept4(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+            if (fd == -1) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return;
+                } else if (errno == ECONNABORTED || errno == EINTR) {
+                    continue;
+                } else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    std::cerr << "Failed to accept connection: " << strerror(errno) << std::endl;
+                    return;
+                }
+
+                throw errno_to_system_error("Failed to accept connection");
+            }
+
+            add_connection(TCPClientSocket(fd, address, address_size, true),
+                            now,
+                            std::forward<AddConnectionLambda>(add_connection_lambda));
+        }
+    }
+
+    template <typename AddConnectionLambda>
+    void add_connection(TCPClientSocket&& socket, const TimerWheel::Clock::time_point now, AddConnectionLambda&& add_connection_lambda) {
+        const auto fd = socket.get_fd();
+        const auto handle = connections.emplace(std::forward<AddConnectionLambda>(add_connection_lambda)(std::move(socket), ++connection_sequence_number));
+
+        // Data queued for this connection by another one (e.g. a broadcast) does not produce an
+        // edge, so it is flushed at the end of the current batch instead.
+        connections[handle].set_write_pending_handler([this, handle]() {
+            write_pending_handles.push_back(handle);
+        });
+
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = handle;
+
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+            connections.erase(handle);
+            throw errno_to_system_error("Failed to add connection to epoll");
+        }
+
+        timers.arm(handle, connections[handle].get_deadline(now));
+    }
+
+    void expire_connections(const TimerWheel::Clock::time_point now) {
+        timers.expire(now, [this, now](const ConnectionHandle handle) {
+            auto& connection = connections[handle];
+            const auto deadline = connection.get_deadline(now);
+
+            if (deadline > now) {
+                timers.arm(handle, deadline);
+                return;
+            }
+
+            std::cerr << "Connection (ID: " << connection.get_id() << ") timed out." << std::endl;
+            remove_connection(handle);
+        });
+    }
+
+    bool handle_events(const ConnectionHandle handle, const short events) {
+        auto& connection = connections[handle];
+
+        try {
+            if (connection.handle_events(events)) {
+                remove_connection(handle);
+                return true;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Connection (ID: " << connection.get_id() << ") removed due to error: " << e.what() << std::endl;
+            remove_connection(handle);
+            return true;
+        } catch (...) {
+            std::cerr << "Connection (ID: " << connection.get_id() << ") removed due to error." << std::endl;
+            remove_connection(handle);
+            return true;
+        }
+
+        return false;
+    }
+
+    // A level-triggered listening socket with a backlog would otherwise report it on every wait.
+    // The sockets stay registered without events, and report the backlog again once re-armed.
+    void set_accepting(const bool is_accepting) {
+        for (std::size_t i{0}; i < listen_fds.size(); ++i) {
+            epoll_event event = {};
+            event.events = is_accepting ? static_cast<uint32_t>(EPOLLIN) : 0;
+            event.data.u64 = listen_event_data + i;
+
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, listen_fds[i], &event) == -1) {
+                throw errno_to_system_error("Failed to modify listening socket in epoll");
+            }
+        }
+
+        this->is_accepting = is_accepting;
+    }
+
+    void remove_connection(const ConnectionHandle handle) noexcept {
+        // Closing the socket also removes it from the epoll set.
+        timers.cancel(handle);
+        connections.erase(handle);
+    }
+
+public:
+    EpollData(const std::size_t max_connections) :
+        connection_sequence_number(0),
+        epoll_fd(epoll_create1(EPOLL_CLOEXEC)),
+        listen_fds(),
+        is_accepting(true),
+        max_connections(max_connections),
+        connections(),
+        events(max_events),
+        timers(),
+        wakeup_event(nullptr),
+        write_pending_handles()
+    {
+        assert(max_connections > 0);
+
+        if (epoll_fd == -1) {
+            throw errno_to_system_error("Failed to create epoll instance");
+        }
+    }
+
+    ~EpollData() {
+        connections.clear();
+        close(epoll_fd);
+    }
+
+    EpollData(EpollData const &) = delete;
+    EpollData(EpollData&&) = delete;
+    EpollData& operator=(const EpollData&) = delete;
+    EpollData& operator=(EpollData&&) = delete;
+
+    void add_listen_fd(const int listen_fd) {
+        // Listening sockets stay level-triggered so a backlog left behind by the cap on accepts
+        // per wakeup, or while at capacity, keeps being reported.
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = listen_event_data + listen_fds.size();
+
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) == -1) {
+            throw errno_to_system_error("Failed to add listening socket to epoll");
+        }
+
+        listen_fds.push_back(listen_fd);
+    }
+
+    void flush() {
+        for (std::size_t i{0}; i < write_pending_handles.size(); ++i) {
+            const auto handle = write_pending_handles[i];
+            const auto connection = connections.find(handle);
+
+            if (connection == nullptr) {
+                continue;
+            }
+
+            if (connection->is_slow_consumer()) {
+                std::cerr << "Connection (ID: " << connection->get_id() << ") removed as a slow consumer." << std::endl;
+                remove_connection(handle);
+            } else if (connection->is_ready_to_write()) {
+                handle_events(handle, POLLWRNORM);
+            }
+        }
+
+        write_pending_handles.clear();
+    }
+
+    bool has_pending_writes() const {
+        return connections.any_of([](const TConnection& connection) {
+            return connection.is_ready_to_write();
+        });
+    }
+
+    template <typename AddConnectionLambda>
+    void poll(const int timeout, AddConnectionLambda&& add_connection_lambda) {
+        const auto events_ready = epoll_wait(epoll_fd, events.data(), events.size(), timers.get_timeout(TimerWheel::Clock::now(), timeout));
+
+        if (events_ready == -1) {
+            throw errno_to_system_error("Failed to wait for epoll events");
+        }
+
+        const auto now = TimerWheel::Clock::now();
+
+        for (int i{0}; i < events_ready; ++i) {
+            const auto& event = events[i];
+
+            if (event.data.u64 == wakeup_event_data) {
+                wakeup_event->drain();
+                continue;
+            }
+
+            if (event.data.u64 >= listen_event_data) {
+                accept_connections(listen_fds[event.data.u64 - listen_event_data], now, std::forward<AddConnectionLambda>(add_connection_lambda));
+                continue;
+            }
+
+            const auto handle = static_cast<ConnectionHandle>(event.data.u64);
+
+            if (handle_events(handle, to_poll_events(event.events))) {
+                continue;
+            }
+
+            auto& connection = connections[handle];
+            timers.arm(handle, connection.get_deadline(now));
+
+            if (connection.is_ready_to_write()) {
+                write_pending_handles.push_back(handle);
+            }
+        }
+
+        expire_connections(now);
+        flush();
+
+        if (!is_accepting && connections.size() < max_connections) {
+            set_accepting(true);
+        }
+    }
+
+    void remove_listen_fds() noexcept {
+        for (const auto listen_fd : listen_fds) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, listen_fd, nullptr);
+        }
+
+        listen_fds.clear();
+    }
+
+    void set_wakeup_event(EventFD& wakeup_event) {
+        assert(this->wakeup_event == nullptr);
+
+        this->wakeup_event = &wakeup_event;
+
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = wakeup_event_data;
+
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_event.get_fd(), &event) == -1) {
+            throw errno_to_system_error("Failed to add wakeup eventfd to epoll");
+        }
+    }
+};
\ No newline at end of file
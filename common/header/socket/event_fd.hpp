@@ -0,0 +1,22 @@
+#pragma once
+
+// Non-blocking eventfd(2) used to wake a reactor blocked in poll from another thread or from a
+// signal handler (notify only calls write, which is async-signal-safe).
+class EventFD {
+private:
+    int fd;
+
+public:
+    EventFD();
+    ~EventFD();
+    EventFD(EventFD const &) = delete;
+    EventFD(EventFD&&) = delete;
+    EventFD& operator=(const EventFD&) = delete;
+    EventFD& operator=(EventFD&&) = delete;
+
+    int get_fd() const noexcept;
+
+    // Clears pending notifications after the descriptor was reported readable.
+    void drain() noexcept;
+    void notify() noexcept;
+};
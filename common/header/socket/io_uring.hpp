@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+
+// Minimal io_uring(7) wrapper on top of the raw system calls. It owns the submission and
+// completion rings and a ring of provided receive buffers, and throws std::system_error from
+// its constructor when the kernel does not offer everything the server relies on.
+class IoUring {
+private:
+    int fd;
+    void* ring;
+    std::size_t ring_size;
+    io_uring_sqe* sqes;
+    std::size_t sqes_size;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_ring_mask;
+    unsigned* sq_array;
+    unsigned sq_entries;
+    unsigned sq_local_tail;
+    unsigned sq_pending;
+
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_ring_mask;
+    io_uring_cqe* cqes;
+
+    io_uring_buf* buffer_ring;
+    std::size_t buffer_ring_size;
+    unsigned short buffer_ring_tail;
+    const unsigned short buffer_count;
+    const std::size_t buffer_size;
+    std::vector<unsigned char> buffers;
+
+    void enter(const unsigned wait_count, const int timeout);
+    // Returns nullptr if the submission queue is still full after submitting.
+    io_uring_sqe* get_sqe();
+    void release() noexcept;
+    void setup(const unsigned entries);
+    void setup_buffer_ring();
+
+public:
+    static constexpr unsigned short buffer_group = 0;
+
+    IoUring(const unsigned entries, const unsigned short buffer_count, const std::size_t buffer_size);
+    ~IoUring();
+    IoUring(IoUring const &) = delete;
+    IoUring(IoUring&&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+    IoUring& operator=(IoUring&&) = delete;
+
+    template <typename CompletionHandler>
+    void for_each_completion(CompletionHandler&& completion_handler) {
+        auto head = *cq_head;
+        const auto tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+        while (head != tail) {
+            const auto cqe = cqes[head & *cq_ring_mask];
+            __atomic_store_n(cq_head, ++head, __ATOMIC_RELEASE);
+            completion_handler(cqe);
+        }
+    }
+
+    const unsigned char* get_buffer(const unsigned short buffer_id) const noexcept;
+    void recycle_buffer(const unsigned short buffer_id) noexcept;
+
+    // These return false if the submission queue is full, which happens when completions are
+    // backed up, so the operation has to be prepared again once they have been handled.
+    bool prepare_accept(const int listen_fd, const __u64 user_data);
+    bool prepare_read(const int fd, void* const buffer, const std::size_t size, const __u64 user_data);
+    bool prepare_receive(const int fd, const __u64 user_data);
+    // The message and its vectors must stay valid until the send completes.
+    bool prepare_send_message(const int fd, const msghdr* const message, const __u64 user_data);
+
+    void submit_and_wait(const int timeout);
+};
@@ -0,0 +1,378 @@
+#pragma once
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <exception.hpp>
+#include <socket/connection_id.hpp>
+#include <socket/connection_pool.hpp>
+#include <socket/event_fd.hpp>
+#include <socket/io_uring.hpp>
+#include <socket/tcp_client_socket.hpp>
+#include <timer_wheel.hpp>
+
+// io_uring(7) reactor with the same interface as PollData. Connections are accepted with a
+// multishot accept, receive into provided buffers and have their sends batched, so a single
+// io_uring_enter per call of poll submits all pending operations and waits for completions.
+template <typename TConnection>
+class IoUringData {
+private:
+    enum class Operation : unsigned char {
+        Accept,
+        Receive,
+        Send,
+        Wakeup
+    };
+
+    static constexpr std::size_t max_send_vectors = 16;
+
+    struct ConnectionEntry {
+        TConnection connection;
+        // Pending output is gathered into one send, whose message has to stay valid while it is
+        // in flight.
+        msghdr send_message;
+        iovec send_vectors[max_send_vectors];
+        bool is_closing;
+        bool is_receiving;
+        bool is_sending;
+
+        ConnectionEntry(TConnection&& connection) :
+            connection(std::move(connection)),
+            send_message(),
+            send_vectors(),
+            is_closing(false),
+            is_receiving(false),
+            is_sending(false)
+        {
+            send_message.msg_iov = send_vectors;
+        }
+    };
+
+    static constexpr unsigned ring_entries = 4096;
+    static constexpr unsigned short buffer_count = 1024;
+    static constexpr std::size_t buffer_size = 4096;
+
+    ConnectionID connection_sequence_number;
+    IoUring ring;
+    // Listening sockets with whether a multishot accept is in flight on each; the user data of an
+    // accept carries the index of its socket.
+    std::vector<int> listen_fds;
+    std::vector<bool> accepting_listen_fds;
+    bool is_listening;
+    bool is_reading_wakeup;
+    std::size_t max_connections;
+    ConnectionPool<ConnectionEntry> connections;
+    TimerWheel timers;
+    EventFD* wakeup_event;
+    std::uint64_t wakeup_value;
+    std::vector<ConnectionHandle> write_pending_handles;
+    // Connections whose operations did not fit into the submission queue, retried by the next
+    // flush.
+    std::vector<ConnectionHandle> deferred_handles;
+
+    static __u64 to_user_data(const ConnectionHandle handle, const Operation operation) noexcept {
+        return static_cast<__u64>(handle) << 2 | static_cast<__u64>(operation);
+    }
+
+    template <typename AddConnectionLambda>
+    void add_connection(const int fd, const TimerWheel::Clock::time_point now, AddConnectionLambda&& add_connection_lambda) {
+        // The multishot accept does not capture peer addresses; they are queried if ever needed.
+        const sockaddr_storage address = {};
+        const auto handle = connections.emplace(std::forward<AddConnectionLambda>(add_connection_lambda)(TCPClientSocket(fd, address, 0, false), ++connection_sequence_number));
+        auto& entry = connections[handle];
+
+        entry.connection.set_write_pending_handler([this, handle]() {
+            write_pending_handles.push_back(handle);
+        });
+
+        write_pending_handles.push_back(handle);
+        timers.arm(handle, entry.connection.get_deadline(now));
+    }
+
+    void expire_connections(const TimerWheel::Clock::time_point now) {
+        timers.expire(now, [this, now](const ConnectionHandle handle) {
+            auto& entry = connections[handle];
+            const auto deadline = entry.connection.get_deadline(now);
+
+            if (deadline > now) {
+                timers.arm(handle, deadline);
+                return;
+            }
+
+            std::cerr << "Connection (ID: " << entry.connection.get_id() << ") timed out." << std::endl;
+            remove_connection(handle, entry);
+
+            if (!entry.is_receiving && !entry.is_sending) {
+                connections.erase(handle);
+            }
+        });
+    }
+
+    void handle_accept(const std::size_t index, const io_uring_cqe& cqe) {
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            accepting_listen_fds[index] = false;
+        }
+
+        // Errors after the listening sockets have been shut down are expected.
+        if (cqe.res < 0 && is_listening) {
+            std::cerr << "Failed to accept connection: " << strerror(-cqe.res) << std::endl;
+        }
+    }
+
+    template <typename AddConnectionLambda>
+    void handle_completion(const io_uring_cqe& cqe, const TimerWheel::Clock::time_point now, AddConnectionLambda&& add_connection_lambda) {
+        const auto handle = static_cast<ConnectionHandle>(cqe.user_data >> 2);
+        const auto operation = static_cast<Operation>(cqe.user_data & 0x3);
+
+        if (operation == Operation::Wakeup) {
+            is_reading_wakeup = false;
+            return;
+        }
+
+        if (operation == Operation::Accept) {
+            handle_accept(handle, cqe);
+
+            if (cqe.res < 0) {
+                return;
+            }
+
+            // A multishot accept cannot leave connections in the backlog, so connections above
+            // the maximum (or accepted after listening stopped) are closed right away.
+
+            if (!is_listening) {
+                close(cqe.res);
+            } else if (connections.size() < max_connections) {
+                add_connection(cqe.res, now, std::forward<AddConnectionLambda>(add_connection_lambda));
+            } else {
+                std::cerr << "Ignoring further connections due to maximum connections reached." << std::endl;
+                close(cqe.res);
+            }
+
+            return;
+        }
+
+        const auto has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+        const auto buffer_id = static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        // A slot is only released once no operation on it is in flight, so the handle of a
+        // completion always refers to its own connection.
+        auto& entry = connections[handle];
+
+        if (operation == Operation::Receive) {
+            entry.is_receiving = false;
+
+            if (cqe.res > 0) {
+                if (!entry.is_closing) {
+                    handle_received(handle, entry, ring.get_buffer(buffer_id), cqe.res, now);
+                }
+            } else if (cqe.res == 0 && !entry.is_closing) {
+                // Flushed so the rest of the output is sent before the connection is closed.
+                entry.connection.handle_hang_up();
+                write_pending_handles.push_back(handle);
+            } else if (cqe.res == -ENOBUFS) {
+                // Every provided buffer is in use; try again once some have been recycled.
+                write_pending_handles.push_back(handle);
+            } else if (!entry.is_closing) {
+                handle_error(handle, entry, cqe.res);
+            }
+
+            if (has_buffer) {
+                ring.recycle_buffer(buffer_id);
+            }
+        } else {
+            entry.is_sending = false;
+
+            if (cqe.res >= 0) {
+                entry.connection.handle_sent(cqe.res);
+                write_pending_handles.push_back(handle);
+            } else if (!entry.is_closing) {
+                handle_error(handle, entry, cqe.res);
+            }
+        }
+
+        if (entry.is_closing && !entry.is_receiving && !entry.is_sending) {
+            connections.erase(handle);
+        }
+    }
+
+    void handle_error(const ConnectionHandle handle, ConnectionEntry& entry, const int result) {
+        if (result < 0 && result != -ECONNRESET && result != -ENOTCONN && result != -EPIPE) {
+            std::cerr << "Connection (ID: " << entry.connection.get_id() << ") removed due to error: " << strerror(-result) << std::endl;
+        }
+
+        remove_connection(handle, entry);
+    }
+
+    void handle_received(const ConnectionHandle handle, ConnectionEntry& entry, const unsigned char* const buffer, const std::size_t size, const TimerWheel::Clock::time_point now) {
+        try {
+            if (entry.connection.handle_received(buffer, size)) {
+                remove_connection(handle, entry);
+                return;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Connection (ID: " << entry.connection.get_id() << ") removed due to error: " << e.what() << std::endl;
+            remove_connection(handle, entry);
+            return;
+        } catch (...) {
+            std::cerr << "Connection (ID: " << entry.connection.get_id() << ") removed due to error." << std::endl;
+            remove_connection(handle, entry);
+            return;
+        }
+
+        timers.arm(handle, entry.connection.get_deadline(now));
+        write_pending_handles.push_back(handle);
+    }
+
+    bool receive(const ConnectionHandle handle, ConnectionEntry& entry) {
+        entry.is_receiving = ring.prepare_receive(entry.connection.get_fd(), to_user_data(handle, Operation::Receive));
+        return entry.is_receiving;
+    }
+
+    // Operations still in flight reference the connection, so it is only destroyed once they have
+    // completed (see handle_completion). Shutting the socket down makes them complete promptly.
+    void remove_connection(const ConnectionHandle handle, ConnectionEntry& entry) noexcept {
+        timers.cancel(handle);
+        entry.is_closing = true;
+
+        if (entry.is_receiving || entry.is_sending) {
+            shutdown(entry.connection.get_fd(), SHUT_RDWR);
+        }
+    }
+
+public:
+    IoUringData(const std::size_t max_connections) :
+        connection_sequence_number(0),
+        ring(ring_entries, buffer_count, buffer_size),
+        listen_fds(),
+        accepting_listen_fds(),
+        is_listening(true),
+        is_reading_wakeup(false),
+        max_connections(max_connections),
+        connections(),
+        timers(),
+        wakeup_event(nullptr),
+        wakeup_value(0),
+        write_pending_handles(),
+        deferred_handles()
+    {
+        assert(max_connections > 0);
+    }
+
+    IoUringData(IoUringData const &) = delete;
+    IoUringData(IoUringData&&) = delete;
+    IoUringData& operator=(const IoUringData&) = delete;
+    IoUringData& operator=(IoUringData&&) = delete;
+
+    void add_listen_fd(const int listen_fd) {
+        listen_fds.push_back(listen_fd);
+        accepting_listen_fds.push_back(false);
+    }
+
+    // Prepares the operations queued since the last call; they are submitted by the next poll.
+    void flush() {
+        for (std::size_t i{0}; is_listening && i < listen_fds.size(); ++i) {
+            if (!accepting_listen_fds[i]) {
+                accepting_listen_fds[i] = ring.prepare_accept(listen_fds[i], to_user_data(static_cast<ConnectionHandle>(i), Operation::Accept));
+            }
+        }
+
+        if (!is_reading_wakeup && wakeup_event != nullptr) {
+            is_reading_wakeup = ring.prepare_read(wakeup_event->get_fd(), &wakeup_value, sizeof(wakeup_value), to_user_data(0, Operation::Wakeup));
+        }
+
+        write_pending_handles.insert(write_pending_handles.end(), deferred_handles.begin(), deferred_handles.end());
+        deferred_handles.clear();
+
+        for (std::size_t i{0}; i < write_pending_handles.size(); ++i) {
+            const auto handle = write_pending_handles[i];
+            const auto pending_entry = connections.find(handle);
+
+            if (pending_entry == nullptr || pending_entry->is_closing) {
+                continue;
+            }
+
+            auto& entry = *pending_entry;
+
+            if (entry.connection.is_slow_consumer()) {
+                std::cerr << "Connection (ID: " << entry.connection.get_id() << ") removed as a slow consumer." << std::endl;
+                remove_connection(handle, entry);
+
+                if (!entry.is_receiving && !entry.is_sending) {
+                    connections.erase(handle);
+                }
+
+                continue;
+            }
+
+            if (entry.connection.is_hung_up()) {
+                // The peer may only have shut down its sending side, so it gets the responses it
+                // is still waiting for before the connection is closed.
+                if (!entry.is_sending && !entry.connection.is_ready_to_write()) {
+                    remove_connection(handle, entry);
+
+                    if (!entry.is_receiving) {
+                        connections.erase(handle);
+                    }
+
+                    continue;
+                }
+            } else if (!entry.is_receiving && !receive(handle, entry)) {
+                deferred_handles.push_back(handle);
+                continue;
+            }
+
+            if (!entry.is_sending && entry.connection.is_ready_to_write()) {
+                entry.send_message.msg_iovlen = entry.connection.peek_write(entry.send_vectors, max_send_vectors);
+                entry.is_sending = ring.prepare_send_message(entry.connection.get_fd(), &entry.send_message, to_user_data(handle, Operation::Send));
+
+                if (!entry.is_sending) {
+                    deferred_handles.push_back(handle);
+                }
+            }
+        }
+
+        write_pending_handles.clear();
+    }
+
+    bool has_pending_writes() const {
+        return connections.any_of([](const ConnectionEntry& entry) {
+            return !entry.is_closing && (entry.is_sending || entry.connection.is_ready_to_write());
+        });
+    }
+
+    template <typename AddConnectionLambda>
+    void poll(const int timeout, AddConnectionLambda&& add_connection_lambda) {
+        flush();
+        // Deferred operations are prepared again as soon as the completions have been handled.
+        ring.submit_and_wait(deferred_handles.empty() ? timers.get_timeout(TimerWheel::Clock::now(), timeout) : 0);
+
+        const auto now = TimerWheel::Clock::now();
+
+        ring.for_each_completion([&](const io_uring_cqe& cqe) {
+            handle_completion(cqe, now, std::forward<AddConnectionLambda>(add_connection_lambda));
+        });
+
+        expire_connections(now);
+    }
+
+    // Accepts still in flight complete once the listening sockets are shut down.
+    void remove_listen_fds() noexcept {
+        is_listening = false;
+    }
+
+    // The eventfd is read through the ring, which consumes the notification.
+    void set_wakeup_event(EventFD& wakeup_event) noexcept {
+        this->wakeup_event = &wakeup_event;
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <socket/socket.hpp>
+
+// Options of a listening TCP socket. Except for defer_accept they are inherited by the
+// connections accepted on it, so they cost nothing per connection. Zero sizes and timeouts keep
+// the kernel defaults.
+struct SocketOptions {
+    std::chrono::microseconds busy_poll;
+    std::chrono::seconds defer_accept;
+    // Chat frames are small and latency bound, so Nagle's algorithm is disabled by default.
+    bool no_delay;
+    int not_sent_low_water_mark;
+    int receive_buffer_size;
+    int send_buffer_size;
+
+    SocketOptions() noexcept;
+};
+
+// Listening stream socket bound to a TCP (IPv4 or IPv6) address or to a Unix domain socket path.
+class ListenerSocket : public Socket {
+private:
+    sockaddr_storage address;
+    socklen_t address_size;
+    // Set once a Unix domain socket is bound, so its path is removed again when it is closed.
+    bool is_path_owner;
+
+    ListenerSocket(const int fd, const sockaddr_storage& address, const socklen_t address_size) noexcept;
+
+public:
+    ListenerSocket(const addrinfo& address);
+    explicit ListenerSocket(const std::string& path);
+    virtual ~ListenerSocket();
+    ListenerSocket(ListenerSocket const &) = delete;
+    ListenerSocket(ListenerSocket&&) noexcept;
+    ListenerSocket& operator=(const ListenerSocket&) = delete;
+    ListenerSocket& operator=(ListenerSocket&&) = delete;
+
+    // Creates a socket for every address the host (all local addresses if empty) resolves to,
+    // skipping address families the system does not support.
+    static std::vector<ListenerSocket> resolve(const std::string& host, const std::string& port);
+
+    using Socket::is_reuse_address;
+    using Socket::is_reuse_port;
+    using Socket::set_defer_accept;
+    using Socket::set_no_delay;
+    using Socket::set_not_sent_low_water_mark;
+    using Socket::set_reuse_address;
+    using Socket::set_reuse_port;
+
+    // A stale socket file left at the path of a Unix domain socket is removed first.
+    void bind();
+
+    // Returns a socket sharing the same accept queue, e.g. for another reactor to accept on.
+    ListenerSocket duplicate() const;
+
+    int get_family() const noexcept;
+    // Returns "address:port" ("[address]:port" for IPv6) or the path of a Unix domain socket.
+    std::string get_name() const;
+    void listen(const std::size_t max_pending_connections) const;
+    // Must only be called on TCP sockets.
+    void set_options(const SocketOptions& options);
+};
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <exception.hpp>
+#include <socket/connection_id.hpp>
+#include <socket/connection_pool.hpp>
+#include <socket/event_fd.hpp>
+#include <socket/tcp_client_socket.hpp>
+#include <timer_wheel.hpp>
+
+// The first pollfd slot holds the wakeup eventfd and the following ones the listening sockets;
+// connections follow from first_connection_index.
+template <typename TConnection>
+class PollData {
+private:
+    static constexpr std::size_t max_accepts_per_poll = 64;
+    static constexpr std::size_t min_connection_fds = 64;
+
+    ConnectionID connection_sequence_number;
+    std::size_t connection_fds_index;
+    std::size_t first_connection_index;
+    // Cleared while at the maximum number of connections, with the listening sockets disarmed.
+    bool is_accepting;
+    std::size_t max_connections;
+    std::vector<ConnectionHandle> connection_handles;
+    std::vector<pollfd> connection_fds;
+    std::vector<std::size_t> connection_fds_indices;
+    ConnectionPool<TConnection> connections;
+    TimerWheel timers;
+    EventFD* wakeup_event;
+    std::vector<ConnectionHandle> write_pending_handles;
+
+    template <typename AddConnectionLambda>
+    void accept_connections(const int listen_fd, const TimerWheel::Clock::time_point now, AddConnectionLambda&& add_connection_lambda) {
+        // Accepts are capped per wakeup so a connect storm cannot starve established connections;
+        // the rest of the backlog is reported by the next poll.
+        for (std::size_t i{0}; i < max_accepts_per_poll; ++i) {
+            if (connections.size() >= max_connections) {
+                if (is_accepting) {
+                    std::cerr << "Not accepting further connections until one is closed, as the maximum has been reached." << std::endl;
+                    set_accepting(false);
+                }
+
+                return;
+            }
+
+            sockaddr_storage address;
+            socklen_t address_size = sizeof(address);
+            const auto fd = accept4(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+            if (fd == -1) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return;
+                } else if (errno == ECONNABORTED || errno == EINTR) {
+                    continue;
+                } else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    std::cerr << "Failed to accept connection: " << strerror(errno) << std::endl;
+                    return;
+                }
+
+                throw errno_to_system_error("Failed to accept connection");
+            }
+
+            add_connection(TCPClientSocket(fd, address, address_size, true),
+                            now,
+                            std::forward<AddConnectionLambda>(add_connection_lambda));
+        }
+    }
+
+    template <typename AddConnectionLambda>
+    void add_connection(TCPClientSocket&& socket, const TimerWheel::Clock::time_point now, AddConnectionLambda&& add_connection_lambda) {
+        assert(connections.size() < max_connections);
+
+        // Slots in use are kept dense at the front of the array, so the first free slot is always
+        // at connection_fds_index and the array only grows (on demand, up to one slot per
+        // connection plus the listening socket and eventfd) when every slot is in use.
+        if (connection_fds_index == connection_fds.size()) {
+            const auto size = std::min(std::max(connection_fds.size() * 2, min_connection_fds), max_connections + first_connection_index);
+            connection_fds.resize(size, { -1, 0, 0 });
+            connection_handles.resize(size, ConnectionPool<TConnection>::invalid_handle);
+        }
+
+        const auto fd = socket.get_fd();
+        const auto handle = connections.emplace(std::forward<AddConnectionLambda>(add_connection_lambda)(std::move(socket), ++connection_sequence_number));
+
+        if (handle >= connection_fds_indices.size()) {
+            connection_fds_indices.resize(static_cast<std::size_t>(handle) + 1);
+        }
+
+        connection_handles[connection_fds_index] = handle;
+        connection_fds[connection_fds_index] = { fd, POLLRDNORM, 0 };
+        connection_fds_indices[handle] = connection_fds_index;
+        ++connection_fds_index;
+
+        // Data queued for this connection by another one (e.g. a broadcast) is written in flush,
+        // as the scan after poll only visits connections that had events.
+        connections[handle].set_write_pending_handler([this, handle]() {
+            write_pending_handles.push_back(handle);
+        });
+
+        timers.arm(handle, connections[handle].get_deadline(now));
+    }
+
+    void expire_connections(const TimerWheel::Clock::time_point now) {
+        timers.expire(now, [this, now](const ConnectionHandle handle) {
+            auto& connection = connections[handle];
+            const auto deadline = connection.get_deadline(now);
+
+            if (deadline > now) {
+                timers.arm(handle, deadline);
+                return;
+            }
+
+            std::cerr << "Connection (ID: " << connection.get_id() << ") timed out." << std::endl;
+            remove_connection(connection_fds_indices[handle]);
+        });
+    }
+
+    // The end of the stream stays readable, so a connection whose peer hung up only waits to
+    // write the rest of its output.
+    static short get_events(const TConnection& connection) noexcept {
+        if (!connection.is_ready_to_write()) {
+            return POLLRDNORM;
+        }
+
+        return connection.is_hung_up() ? POLLWRNORM : POLLRDNORM | POLLWRNORM;
+    }
+
+    // Returns whether the connection was removed.
+    bool handle_events(const std::size_t index, const short events) {
+        auto& connection = connections[connection_handles[index]];
+
+        try {
+            if (connection.handle_events(events)) {
+                remove_connection(index);
+                return true;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Connection (ID: " << connection.get_id() << ") removed due to error: " << e.what() << std::endl;
+            remove_connection(index);
+            return true;
+        } catch (...) {
+            std::cerr << "Connection (ID: " << connection.get_id() << ") removed due to error." << std::endl;
+            remove_connection(index);
+            return true;
+        }
+
+        return false;
+    }
+
+    // A listening socket with a backlog would otherwise be reported readable by every poll. Its
+    // slot is kept without events, so it reports the backlog again once re-armed.
+    void set_accepting(const bool is_accepting) noexcept {
+        for (std::size_t i{1}; i < first_connection_index; ++i) {
+            connection_fds[i].events = is_accepting ? POLLRDNORM : 0;
+        }
+
+        this->is_accepting = is_accepting;
+    }
+
+    // Moves the last slot in use into the freed one, including its revents from the current poll.
+    void remove_connection(const std::size_t index) {
+        assert(index >= first_connection_index && index < connection_fds_index);
+
+        timers.cancel(connection_handles[index]);
+        connections.erase(connection_handles[index]);
+
+        const auto last_index = --connection_fds_index;
+
+        if (index != last_index) {
+            connection_fds[index] = connection_fds[last_index];
+            connection_handles[index] = connection_handles[last_index];
+            connection_fds_indices[connection_handles[index]] = index;
+        }
+
+        connection_fds[last_index] = { -1, 0, 0 };
+        connection_handles[last_index] = ConnectionPool<TConnection>::invalid_handle;
+    }
+
+public:
+    PollData(const std::size_t max_connections) :
+        connection_sequence_number(0),
+        connection_fds_index(1),
+        first_connection_index(1),
+        is_accepting(true),
+        max_connections(max_connections),
+        connection_handles(1, ConnectionPool<TConnection>::invalid_handle),
+        connection_fds(1, { -1, POLLIN, 0 }),
+        connection_fds_indices(),
+        connections(),
+        timers(),
+        wakeup_event(nullptr),
+        write_pending_handles()
+    {
+        assert(max_connections > 0);
+    }
+
+    // Listening sockets are added before any connection, as their slots precede the connections'.
+    void add_listen_fd(const int listen_fd) {
+        assert(connection_fds_index == first_connection_index);
+
+        connection_fds.insert(connection_fds.begin() + first_connection_index, { listen_fd, POLLRDNORM, 0 });
+        connection_handles.insert(connection_handles.begin() + first_connection_index, ConnectionPool<TConnection>::invalid_handle);
+        ++first_connection_index;
+        ++connection_fds_index;
+    }
+
+    void flush() {
+        for (std::size_t i{0}; i < write_pending_handles.size(); ++i) {
+            const auto handle = write_pending_handles[i];
+            const auto connection = connections.find(handle);
+
+            if (connection == nullptr) {
+                continue;
+            }
+
+            const auto index = connection_fds_indices[handle];
+
+            // A slow consumer's socket is usually not writable, so it cannot wait for POLLWRNORM
+            // to be closed.
+            if (connection->is_slow_consumer()) {
+                std::cerr << "Connection (ID: " << connection->get_id() << ") removed as a slow consumer." << std::endl;
+                remove_connection(index);
+                continue;
+            }
+
+            // Output is written right away instead of after another poll, which only has to
+            // report POLLWRNORM once the socket's send buffer has been found full.
+            if (!connection->is_ready_to_write() || (connection_fds[index].events & POLLWRNORM) || handle_events(index, POLLWRNORM)) {
+                continue;
+            }
+
+            connection_fds[index].events = get_events(*connection);
+        }
+
+        write_pending_handles.clear();
+    }
+
+    bool has_pending_writes() const {
+        return connections.any_of([](const TConnection& connection) {
+            return connection.is_ready_to_write();
+        });
+    }
+
+    template <typename AddConnectionLambda>
+    void poll(const int timeout, AddConnectionLambda&& add_connection_lambda) {
+        auto connections_ready = ::poll(connection_fds.data(),
+                                        connection_fds_index,
+                                        timers.get_timeout(TimerWheel::Clock::now(), timeout));
+
+        if (connections_ready == -1) {
+            throw errno_to_system_error("Failed to poll socket");
+        }
+
+        const auto now = TimerWheel::Clock::now();
+
+        if (connection_fds[0].revents & POLLIN) {
+            wakeup_event->drain();
+            --connections_ready;
+        }
+
+        for (std::size_t i{1}; i < first_connection_index; ++i) {
+            if (connection_fds[i].revents & POLLRDNORM) {
+                accept_connections(connection_fds[i].fd, now, std::forward<AddConnectionLambda>(add_connection_lambda));
+                --connections_ready;
+            }
+        }
+
+        // A removed connection's slot is refilled from the end of the array, so the index only
+        // advances past slots that were kept.
+        for (std::size_t i{first_connection_index}; connections_ready > 0 && i < connection_fds_index;) {
+            const auto handle = connection_handles[i];
+            auto& connection = connections[handle];
+
+            if (connection_fds[i].revents > 0) {
+                --connections_ready;
+
+                if (handle_events(i, connection_fds[i].revents)) {
+                    continue;
+                }
+
+                timers.arm(handle, connection.get_deadline(now));
+            }
+
+            // New output is left to flush; output that is still waiting for POLLWRNORM keeps it.
+            if (!connection.is_ready_to_write()) {
+                connection_fds[i].events = POLLRDNORM;
+            } else if (!(connection_fds[i].events & POLLWRNORM)) {
+                write_pending_handles.push_back(handle);
+            } else {
+                connection_fds[i].events = get_events(connection);
+            }
+
+            ++i;
+        }
+
+        expire_connections(now);
+        flush();
+
+        if (!is_accepting && connections.size() < max_connections) {
+            set_accepting(true);
+        }
+    }
+
+    // The slots of the listening sockets are kept, with negative fds that poll ignores.
+    void remove_listen_fds() noexcept {
+        for (std::size_t i{1}; i < first_connection_index; ++i) {
+            connection_fds[i].fd = -1;
+        }
+    }
+
+    void set_wakeup_event(EventFD& wakeup_event) noexcept {
+        this->wakeup_event = &wakeup_event;
+
+        // An eventfd only reports POLLIN, not POLLRDNORM like sockets do.
+        connection_fds[0] = { wakeup_event.get_fd(), POLLIN, 0 };
+    }
+};
+
+template <typename TConnection>
+constexpr std::size_t PollData<TConnection>::min_connection_fds;
\ No newline at end of file
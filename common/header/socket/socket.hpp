@@ -1,28 +1,47 @@
-#pragma once
-
-class Socket {
-private:
-    bool non_blocking;
-    bool reuse_address;
-
-protected:
-    int fd;
-
-    Socket() noexcept;
-    Socket(const int fd) noexcept;
-
-    bool is_reuse_address() const noexcept;
-    void set_reuse_address(const bool reuse_address);
-
-public:
-    Socket(const int domain, const int type, const int protocol);
-    virtual ~Socket();
-    Socket(Socket const &) = delete;
-    Socket(Socket&&) noexcept;
-    Socket& operator=(const Socket&) = delete;
-    Socket& operator=(Socket&&) noexcept;
-
-    int get_fd() const noexcept;
-    bool is_non_blocking() const noexcept;
-    void set_non_blocking(const bool non_blocking);
-};
+#pragma once
+
+#include <chrono>
+
+class Socket {
+private:
+    bool non_blocking;
+    bool reuse_address;
+    bool reuse_port;
+
+protected:
+    int fd;
+
+    Socket() noexcept;
+    Socket(const int fd, const bool non_blocking) noexcept;
+
+    bool is_reuse_address() const noexcept;
+    bool is_reuse_port() const noexcept;
+    void set_reuse_address(const bool reuse_address);
+    void set_reuse_port(const bool reuse_port);
+
+    // TCP only: TCP_DEFER_ACCEPT on a listening socket only wakes accept once data has arrived
+    // (or the timeout has passed), TCP_NODELAY disables Nagle's algorithm and TCP_NOTSENT_LOWAT
+    // limits how much unsent data the kernel queues before the socket stops being writable.
+    void set_defer_accept(const std::chrono::seconds timeout);
+    void set_no_delay(const bool no_delay);
+    void set_not_sent_low_water_mark(const int size);
+
+public:
+    Socket(const int domain, const int type, const int protocol);
+    virtual ~Socket();
+    Socket(Socket const &) = delete;
+    Socket(Socket&&) noexcept;
+    Socket& operator=(const Socket&) = delete;
+    Socket& operator=(Socket&&) noexcept;
+
+    int get_fd() const noexcept;
+    // The kernel reports twice the size that was set, the rest being bookkeeping overhead.
+    int get_receive_buffer_size() const;
+    int get_send_buffer_size() const;
+    bool is_non_blocking() const noexcept;
+    // Busy polls the device queue for up to timeout on blocking receives (SO_BUSY_POLL).
+    void set_busy_poll(const std::chrono::microseconds timeout);
+    void set_non_blocking(const bool non_blocking);
+    void set_receive_buffer_size(const int size);
+    void set_send_buffer_size(const int size);
+};
@@ -1,30 +1,89 @@
-#pragma once
-
-#include <cstddef>
-#include <string>
-
-#include <socket/socket.hpp>
-
-using namespace std;
-
-class TCPClientSocket : public Socket {
-protected:
-    template <typename TConnection>
-    friend class PollData;
-
-    const std::string address;
-    const std::string port;
-
-    TCPClientSocket(std::string address, std::string port, const int fd) noexcept;
-
-public:
-    TCPClientSocket(std::string address, std::string port);
-    virtual ~TCPClientSocket() = default;
-    TCPClientSocket(TCPClientSocket const &) = delete;
-    TCPClientSocket(TCPClientSocket&&) = default;
-    TCPClientSocket& operator=(const TCPClientSocket&) = delete;
-    TCPClientSocket& operator=(TCPClientSocket&&) = default;
-
-    bool recv(unsigned char* const buffer, std::size_t& size);
-    void send(const unsigned char* const buffer, std::size_t& size);
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <socket/socket.hpp>
+
+using namespace std;
+
+enum class IoStatus {
+    // The call transferred what it could: everything for try_send, anything for the others.
+    Complete,
+    WouldBlock,
+    // The peer shut down its side or reset the connection.
+    PeerClosed,
+    Error
+};
+
+// Outcome of a non-blocking transfer, reported without throwing since running out of data or
+// buffer space is routine. Bytes counts what was transferred before the status was reached and
+// error holds errno for IoStatus::Error.
+struct IoResult {
+    IoStatus status;
+    std::size_t bytes;
+    int error;
+};
+
+class TCPClientSocket : public Socket {
+protected:
+    template <typename TConnection>
+    friend class EpollData;
+
+    template <typename TConnection>
+    friend class IoUringData;
+
+    template <typename TConnection>
+    friend class PollData;
+
+    const std::string address;
+    const std::string port;
+    sockaddr_storage peer_address;
+    socklen_t peer_address_size;
+
+    // Wraps an accepted socket. The printable address is only formatted when asked for; if the
+    // peer address was not captured on accept (peer_address_size of 0) it is queried then.
+    TCPClientSocket(const int fd, const sockaddr_storage& peer_address, const socklen_t peer_address_size, const bool non_blocking) noexcept;
+
+    void format_peer_address(std::string& address, std::string& port) const;
+
+public:
+    TCPClientSocket(std::string address, std::string port);
+    // Connects to the Unix domain socket at path.
+    explicit TCPClientSocket(std::string path);
+    virtual ~TCPClientSocket() = default;
+    TCPClientSocket(TCPClientSocket const &) = delete;
+    TCPClientSocket(TCPClientSocket&&) = default;
+    TCPClientSocket& operator=(const TCPClientSocket&) = delete;
+    TCPClientSocket& operator=(TCPClientSocket&&) = default;
+
+    using Socket::set_no_delay;
+    using Socket::set_not_sent_low_water_mark;
+
+    // Enables MSG_ZEROCOPY (SO_ZEROCOPY); returns false if the socket does not support it, like
+    // Unix domain sockets.
+    bool enable_zero_copy();
+    std::string get_address() const;
+    std::string get_port() const;
+
+    bool recv(unsigned char* const buffer, std::size_t& size);
+    void send(const unsigned char* const buffer, std::size_t& size);
+
+    // Receives whatever is available, up to size bytes, with a single call.
+    IoResult try_recv(unsigned char* const buffer, const std::size_t size) noexcept;
+    // Gathers the vectors, which are advanced past the bytes sent, into as few writev calls as
+    // possible, until all of them are sent or the socket would block.
+    IoResult try_send(iovec* vectors, std::size_t count) noexcept;
+    // Sends the vectors with a single MSG_ZEROCOPY sendmsg. The kernel may read the sent bytes
+    // until it reports the send complete on the error queue; every send that sent anything is
+    // numbered, counting from 0.
+    IoResult try_send_zero_copy(const iovec* const vectors, const std::size_t count) noexcept;
+    // Takes the next range of completed zero-copy sends (first to last, inclusive) off the error
+    // queue, along with whether the kernel had to copy the data after all. Returns false once the
+    // error queue is empty.
+    bool take_zero_copy_completion(std::uint32_t& first, std::uint32_t& last, bool& copied);
 };
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+// Characters owned by someone else, like C++17's std::string_view, which the view must not
+// outlive.
+class StringView {
+private:
+    const char* characters;
+    std::size_t length;
+
+public:
+    StringView() noexcept :
+        characters(""),
+        length(0)
+    {
+
+    }
+
+    StringView(const char* const characters, const std::size_t length) noexcept :
+        characters(characters),
+        length(length)
+    {
+
+    }
+
+    template <typename Traits, typename Allocator>
+    StringView(const std::basic_string<char, Traits, Allocator>& string) noexcept :
+        characters(string.data()),
+        length(string.size())
+    {
+
+    }
+
+    const char* begin() const noexcept {
+        return characters;
+    }
+
+    const char* data() const noexcept {
+        return characters;
+    }
+
+    bool empty() const noexcept {
+        return length == 0;
+    }
+
+    const char* end() const noexcept {
+        return characters + length;
+    }
+
+    std::size_t size() const noexcept {
+        return length;
+    }
+
+    std::string to_string() const {
+        return std::string(characters, length);
+    }
+
+    char operator[](const std::size_t index) const noexcept {
+        return characters[index];
+    }
+};
+
+inline int compare(const StringView left, const StringView right) noexcept {
+    const auto result = memcmp(left.data(), right.data(), std::min(left.size(), right.size()));
+
+    if (result != 0) {
+        return result;
+    }
+
+    return left.size() < right.size() ? -1 : (left.size() > right.size() ? 1 : 0);
+}
+
+inline bool operator==(const StringView left, const StringView right) noexcept {
+    return left.size() == right.size() && memcmp(left.data(), right.data(), left.size()) == 0;
+}
+
+inline bool operator!=(const StringView left, const StringView right) noexcept {
+    return !(left == right);
+}
+
+inline bool operator<(const StringView left, const StringView right) noexcept {
+    return compare(left, right) < 0;
+}
+
+inline std::ostream& operator<<(std::ostream& stream, const StringView view) {
+    return stream.write(view.data(), static_cast<std::streamsize>(view.size()));
+}
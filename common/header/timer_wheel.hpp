@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Hierarchical timing wheel with one timer per small integer id (e.g. a connection handle).
+// Timers live in intrusive lists across four levels of 64 slots, each level 64 times coarser than
+// the one below, so arming, re-arming and cancelling are O(1) and timers cascade down a level
+// as their expiry comes within range of it.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerID = std::uint32_t;
+
+private:
+    static constexpr unsigned level_bits = 6;
+    static constexpr std::size_t levels = 4;
+    static constexpr std::size_t slots_per_level = std::size_t{1} << level_bits;
+    static constexpr TimerID invalid_id = std::numeric_limits<TimerID>::max();
+
+    struct Timer {
+        std::uint64_t expiry_tick;
+        TimerID next;
+        TimerID previous;
+        unsigned char level;
+        unsigned char slot;
+        bool is_armed;
+    };
+
+    const Clock::time_point start;
+    const Clock::duration resolution;
+    std::uint64_t current_tick;
+    std::size_t number_of_timers;
+    std::array<std::uint64_t, levels> occupied_slots;
+    std::array<std::array<TimerID, slots_per_level>, levels> slots;
+    std::vector<Timer> timers;
+
+    void cascade() noexcept;
+    std::uint64_t get_next_tick() const noexcept;
+    // Timers expiring before earliest_tick are placed at it: the tick after the current one when
+    // arming, as the current tick has already been processed, or the current tick when cascading.
+    void link(const TimerID id, const std::uint64_t earliest_tick) noexcept;
+    void unlink(const TimerID id) noexcept;
+
+public:
+    TimerWheel(const Clock::duration resolution = std::chrono::milliseconds(10));
+
+    TimerWheel(TimerWheel const &) = delete;
+    TimerWheel(TimerWheel&&) = default;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    TimerWheel& operator=(TimerWheel&&) = delete;
+
+    // Arms (or re-arms) the timer to expire at the deadline, rounded up to the resolution. A
+    // deadline of Clock::time_point::max() cancels it instead.
+    void arm(const TimerID id, const Clock::time_point deadline);
+    void cancel(const TimerID id) noexcept;
+
+    // Returns the poll timeout in milliseconds until the wheel next needs to advance, bounded by
+    // timeout (-1 meaning no bound).
+    int get_timeout(const Clock::time_point now, const int timeout) const noexcept;
+
+    // Advances the wheel to now and calls expire_lambda(id) for every timer that has expired.
+    // The timer is disarmed before the call, so the lambda may re-arm it.
+    template <typename ExpireLambda>
+    void expire(const Clock::time_point now, ExpireLambda&& expire_lambda) {
+        const auto now_tick = now > start ? static_cast<std::uint64_t>((now - start) / resolution) : 0;
+
+        while (number_of_timers > 0) {
+            const auto next_tick = get_next_tick();
+
+            if (next_tick > now_tick) {
+                break;
+            }
+
+            current_tick = next_tick;
+            cascade();
+
+            auto& slot = slots[0][current_tick & (slots_per_level - 1)];
+
+            while (slot != invalid_id) {
+                const auto id = slot;
+                unlink(id);
+                expire_lambda(id);
+            }
+        }
+
+        if (now_tick > current_tick) {
+            current_tick = now_tick;
+        }
+    }
+};
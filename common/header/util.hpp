@@ -1,6 +1,6 @@
-#pragma once
-
-#include <string>
-#include <vector>
-
-std::vector<std::string> split(std::string str, const std::string& delimiter);
+#pragma once
+
+#include <string>
+#include <vector>
+
+std::vector<std::string> split(std::string str, const std::string& delimiter);
@@ -0,0 +1,45 @@
+#include <cassert>
+
+#include <arena.hpp>
+
+using namespace std;
+
+constexpr size_t Arena::min_block_size;
+
+Arena::Arena() :
+    block(new unsigned char[min_block_size]),
+    block_size(min_block_size),
+    offset(0),
+    overflow_blocks(),
+    overflow_size(0)
+{
+
+}
+
+void* Arena::allocate(const size_t size, const size_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= alignof(max_align_t));
+
+    const auto aligned_offset = (offset + alignment - 1) & ~(alignment - 1);
+
+    if (aligned_offset + size <= block_size) {
+        offset = aligned_offset + size;
+        return block.get() + aligned_offset;
+    }
+
+    // Blocks from new[] are suitably aligned for any type.
+    overflow_blocks.emplace_back(new unsigned char[size]);
+    overflow_size += size;
+
+    return overflow_blocks.back().get();
+}
+
+void Arena::reset() {
+    if (!overflow_blocks.empty()) {
+        block_size += overflow_size;
+        block.reset(new unsigned char[block_size]);
+        overflow_blocks.clear();
+        overflow_size = 0;
+    }
+
+    offset = 0;
+}
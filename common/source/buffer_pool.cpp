@@ -0,0 +1,93 @@
+#include <cassert>
+
+#include <buffer_pool.hpp>
+
+using namespace std;
+
+constexpr size_t BufferPool::min_block_size;
+constexpr size_t BufferPool::max_block_size;
+constexpr size_t BufferPool::class_count;
+constexpr size_t BufferPool::max_free_bytes;
+
+array<BufferPoolClassStats, BufferPool::class_count> BufferPool::stats;
+
+BufferPool::BufferPool() noexcept :
+    free_blocks()
+{
+    static_assert(min_block_size << (class_count - 1) == max_block_size, "Size classes must span the block sizes");
+}
+
+BufferPool::~BufferPool() {
+    for (auto& blocks : free_blocks) {
+        for (auto block : blocks) {
+            delete[] block;
+        }
+    }
+}
+
+BufferPool& BufferPool::get_local() {
+    thread_local BufferPool pool;
+    return pool;
+}
+
+size_t BufferPool::get_block_size(const size_t size) noexcept {
+    return min_block_size << get_class(size);
+}
+
+size_t BufferPool::get_class(const size_t size) noexcept {
+    assert(size <= max_block_size);
+
+    size_t size_class = 0;
+
+    while ((min_block_size << size_class) < size) {
+        ++size_class;
+    }
+
+    return size_class;
+}
+
+const array<BufferPoolClassStats, BufferPool::class_count>& BufferPool::get_stats() noexcept {
+    return stats;
+}
+
+unsigned char* BufferPool::acquire(const size_t size) {
+    const auto size_class = get_class(size);
+    auto& blocks = free_blocks[size_class];
+    unsigned char* block;
+
+    if (blocks.empty()) {
+        block = new unsigned char[min_block_size << size_class];
+    } else {
+        block = blocks.back();
+        blocks.pop_back();
+    }
+
+    auto& class_stats = stats[size_class];
+    const auto in_use = class_stats.in_use.fetch_add(1, memory_order_relaxed) + 1;
+    auto high_water = class_stats.high_water.load(memory_order_relaxed);
+
+    while (in_use > high_water && !class_stats.high_water.compare_exchange_weak(high_water, in_use, memory_order_relaxed)) {
+
+    }
+
+    return block;
+}
+
+void BufferPool::release(unsigned char* const block, const size_t size) noexcept {
+    const auto size_class = get_class(size);
+    auto& blocks = free_blocks[size_class];
+
+    stats[size_class].in_use.fetch_sub(1, memory_order_relaxed);
+
+    // A failed push_back leaves the block to be freed like one over the limit.
+    if ((blocks.size() + 1) * (min_block_size << size_class) <= max_free_bytes) {
+        try {
+            blocks.push_back(block);
+            return;
+        } catch (...) {
+
+        }
+    }
+
+    delete[] block;
+}
@@ -0,0 +1,178 @@
+#include <cassert>
+
+#include <protocol/validation.hpp>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace protocol {
+    namespace {
+        // Vector versions compare bytes as signed, so anything from 0x80 up is below every class.
+
+        struct Alnum {
+            static bool is_valid(const unsigned char c) noexcept {
+                const auto lower = c | 0x20;
+                return (c >= '0' && c <= '9') || (lower >= 'a' && lower <= 'z');
+            }
+
+#if defined(__x86_64__)
+            static __m128i get_valid(const __m128i bytes) noexcept {
+                const auto lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+                const auto digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1)));
+                const auto letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+
+                return _mm_or_si128(digit, letter);
+            }
+
+            __attribute__((target("avx2")))
+            static __m256i get_valid(const __m256i bytes) noexcept {
+                const auto lower = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+                const auto digit = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), bytes));
+                const auto letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+
+                return _mm256_or_si256(digit, letter);
+            }
+#endif
+        };
+
+        struct Printable {
+            static bool is_valid(const unsigned char c) noexcept {
+                return c >= 0x20 && c < 0x7F;
+            }
+
+#if defined(__x86_64__)
+            static __m128i get_valid(const __m128i bytes) noexcept {
+                return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(0x1F)), _mm_cmplt_epi8(bytes, _mm_set1_epi8(0x7F)));
+            }
+
+            __attribute__((target("avx2")))
+            static __m256i get_valid(const __m256i bytes) noexcept {
+                return _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(0x1F)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7F), bytes));
+            }
+#endif
+        };
+
+        using Finder = size_t (*)(const char* const data, const size_t size);
+
+        template <typename Class>
+        size_t find_invalid_scalar(const char* const data, size_t offset, const size_t size) noexcept {
+            while (offset < size && Class::is_valid(static_cast<unsigned char>(data[offset]))) {
+                ++offset;
+            }
+
+            return offset;
+        }
+
+#if defined(__x86_64__)
+        // SSE2 is part of x86-64, so this is the baseline there.
+        template <typename Class>
+        size_t find_invalid_sse2(const char* const data, const size_t size) noexcept {
+            size_t offset = 0;
+
+            for (; offset + 16 <= size; offset += 16) {
+                const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+                const auto valid = static_cast<unsigned int>(_mm_movemask_epi8(Class::get_valid(bytes)));
+
+                if (valid != 0xFFFF) {
+                    return offset + __builtin_ctz(~valid);
+                }
+            }
+
+            return find_invalid_scalar<Class>(data, offset, size);
+        }
+
+        template <typename Class>
+        __attribute__((target("avx2")))
+        size_t find_invalid_avx2(const char* const data, const size_t size) noexcept {
+            size_t offset = 0;
+
+            for (; offset + 32 <= size; offset += 32) {
+                const auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+                const auto valid = static_cast<unsigned int>(_mm256_movemask_epi8(Class::get_valid(bytes)));
+
+                if (valid != 0xFFFFFFFF) {
+                    return offset + __builtin_ctz(~valid);
+                }
+            }
+
+            return find_invalid_scalar<Class>(data, offset, size);
+        }
+#endif
+
+        template <typename Class>
+        size_t find_invalid(const char* const data, const size_t size) noexcept {
+            return find_invalid_scalar<Class>(data, 0, size);
+        }
+
+        template <typename Class>
+        Finder get_finder(const ValidationKernel kernel) noexcept {
+            assert(is_supported(kernel));
+
+            switch (kernel) {
+#if defined(__x86_64__)
+                case ValidationKernel::AVX2:
+                    return find_invalid_avx2<Class>;
+
+                case ValidationKernel::SSE2:
+                    return find_invalid_sse2<Class>;
+#endif
+
+                default:
+                    return find_invalid<Class>;
+            }
+        }
+
+        template <typename Class>
+        Finder select_finder() noexcept {
+            if (is_supported(ValidationKernel::AVX2)) {
+                return get_finder<Class>(ValidationKernel::AVX2);
+            }
+
+            if (is_supported(ValidationKernel::SSE2)) {
+                return get_finder<Class>(ValidationKernel::SSE2);
+            }
+
+            return get_finder<Class>(ValidationKernel::Scalar);
+        }
+    }
+
+    size_t find_non_alnum(const char* const data, const size_t size) noexcept {
+        static const auto finder = select_finder<Alnum>();
+        return finder(data, size);
+    }
+
+    size_t find_non_printable(const char* const data, const size_t size) noexcept {
+        static const auto finder = select_finder<Printable>();
+        return finder(data, size);
+    }
+
+    bool is_supported(const ValidationKernel kernel) noexcept {
+        switch (kernel) {
+#if defined(__x86_64__)
+            case ValidationKernel::AVX2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2");
+
+            case ValidationKernel::SSE2:
+                return true;
+#endif
+
+            case ValidationKernel::Scalar:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    size_t find_non_alnum(const char* const data, const size_t size, const ValidationKernel kernel) noexcept {
+        return get_finder<Alnum>(kernel)(data, size);
+    }
+
+    size_t find_non_printable(const char* const data, const size_t size, const ValidationKernel kernel) noexcept {
+        return get_finder<Printable>(kernel)(data, size);
+    }
+}
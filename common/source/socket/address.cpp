@@ -0,0 +1,67 @@
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+
+#include <socket/address.hpp>
+
+using namespace std;
+
+void format_address(const sockaddr_storage& address, const socklen_t address_size, string& ip_address, string& port) {
+    auto family = address.ss_family;
+
+    if (family == AF_UNSPEC) {
+        switch (address_size) {
+            case sizeof(sockaddr_in):
+                family = AF_INET;
+                break;
+            
+            case sizeof(sockaddr_in6):
+                family = AF_INET6;
+                break;
+            
+            default:
+                assert(false);
+        }
+    }
+
+    switch (family) {
+        case AF_INET: {
+            const sockaddr_in *address_in = reinterpret_cast<const sockaddr_in*>(&address);
+            ip_address.resize(INET_ADDRSTRLEN);
+            inet_ntop(AF_INET, &(address_in->sin_addr),
+                        &ip_address[0],
+                        INET_ADDRSTRLEN);
+            ip_address.resize(strlen(ip_address.c_str()));
+            port = to_string(ntohs(address_in->sin_port));
+            break;
+        }
+
+        case AF_INET6: {
+            const sockaddr_in6 *address_in6 = reinterpret_cast<const sockaddr_in6*>(&address);
+            ip_address.resize(INET6_ADDRSTRLEN);
+            inet_ntop(AF_INET6, &(address_in6->sin6_addr),
+                        &ip_address[0],
+                        INET6_ADDRSTRLEN);
+            ip_address.resize(strlen(ip_address.c_str()));
+            port = to_string(ntohs(address_in6->sin6_port));
+            break;
+        }
+
+        case AF_UNIX: {
+            // The path of an unnamed socket (e.g. the client end of a connection) is empty.
+            const sockaddr_un *address_un = reinterpret_cast<const sockaddr_un*>(&address);
+            const auto path_offset = offsetof(sockaddr_un, sun_path);
+            const auto path_size = address_size > path_offset ? address_size - path_offset : 0;
+            ip_address.assign(address_un->sun_path, strnlen(address_un->sun_path, path_size));
+            port.clear();
+            break;
+        }
+
+        default:
+            assert(false);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include <cerrno>
+#include <cstdint>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <exception.hpp>
+#include <socket/event_fd.hpp>
+
+using namespace std;
+
+EventFD::EventFD() :
+    fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (fd == -1) {
+        throw errno_to_system_error("Failed to create eventfd");
+    }
+}
+
+EventFD::~EventFD() {
+    close(fd);
+}
+
+int EventFD::get_fd() const noexcept {
+    return fd;
+}
+
+void EventFD::drain() noexcept {
+    uint64_t value;
+    ssize_t result;
+
+    // The counter is reset by a single read; EAGAIN means it was already drained.
+    do {
+        result = read(fd, &value, sizeof(value));
+    } while (result == -1 && errno == EINTR);
+}
+
+void EventFD::notify() noexcept {
+    const uint64_t value = 1;
+    ssize_t result;
+
+    // Only fails with EAGAIN once the counter is about to overflow, which still leaves the
+    // descriptor readable.
+    do {
+        result = write(fd, &value, sizeof(value));
+    } while (result == -1 && errno == EINTR);
+}
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <exception.hpp>
+#include <socket/io_uring.hpp>
+
+using namespace std;
+
+IoUring::IoUring(const unsigned entries, const unsigned short buffer_count, const size_t buffer_size) :
+    fd(-1),
+    ring(MAP_FAILED),
+    ring_size(0),
+    sqes(static_cast<io_uring_sqe*>(MAP_FAILED)),
+    sqes_size(0),
+    sq_local_tail(0),
+    sq_pending(0),
+    buffer_ring(nullptr),
+    buffer_ring_size(0),
+    buffer_ring_tail(0),
+    buffer_count(buffer_count),
+    buffer_size(buffer_size),
+    buffers()
+{
+    // The buffer ring is indexed with a mask, so its size has to be a power of two.
+    if (buffer_count == 0 || (buffer_count & (buffer_count - 1)) != 0) {
+        throw system_error(EINVAL, system_category(), "Buffer count for io_uring must be a power of two");
+    }
+
+    try {
+        setup(entries);
+        setup_buffer_ring();
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+IoUring::~IoUring() {
+    release();
+}
+
+void IoUring::enter(const unsigned wait_count, const int timeout) {
+    __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+
+    unsigned flags = 0;
+    io_uring_getevents_arg arg = {};
+    __kernel_timespec ts = {};
+    void* argp = nullptr;
+    size_t arg_size = 0;
+
+    if (wait_count > 0) {
+        flags |= IORING_ENTER_GETEVENTS;
+
+        if (timeout >= 0) {
+            ts.tv_sec = timeout / 1000;
+            ts.tv_nsec = (timeout % 1000) * 1000000L;
+            arg.ts = reinterpret_cast<__u64>(&ts);
+
+            flags |= IORING_ENTER_EXT_ARG;
+            argp = &arg;
+            arg_size = sizeof(arg);
+        }
+    }
+
+    const auto result = syscall(__NR_io_uring_enter, fd, sq_pending, wait_count, flags, argp, arg_size);
+
+    if (result == -1) {
+        switch (errno) {
+            case EAGAIN:
+            case EBUSY:
+            case EINTR:
+            case ETIME:
+                return;
+
+            default:
+                throw errno_to_system_error("Failed to enter io_uring");
+        }
+    }
+
+    sq_pending -= min(static_cast<unsigned>(result), sq_pending);
+}
+
+io_uring_sqe* IoUring::get_sqe() {
+    if (sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+        enter(0, 0);
+
+        if (sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+            return nullptr;
+        }
+    }
+
+    const auto index = sq_local_tail & *sq_ring_mask;
+    auto sqe = &sqes[index];
+    memset(sqe, 0, sizeof(io_uring_sqe));
+
+    sq_array[index] = index;
+    ++sq_local_tail;
+    ++sq_pending;
+
+    return sqe;
+}
+
+const unsigned char* IoUring::get_buffer(const unsigned short buffer_id) const noexcept {
+    return buffers.data() + buffer_id * buffer_size;
+}
+
+bool IoUring::prepare_accept(const int listen_fd, const __u64 user_data) {
+    auto sqe = get_sqe();
+
+    if (sqe == nullptr) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool IoUring::prepare_read(const int fd, void* const buffer, const size_t size, const __u64 user_data) {
+    auto sqe = get_sqe();
+
+    if (sqe == nullptr) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<__u64>(buffer);
+    sqe->len = size;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool IoUring::prepare_receive(const int fd, const __u64 user_data) {
+    auto sqe = get_sqe();
+
+    if (sqe == nullptr) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->len = buffer_size;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buffer_group;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool IoUring::prepare_send_message(const int fd, const msghdr* const message, const __u64 user_data) {
+    auto sqe = get_sqe();
+
+    if (sqe == nullptr) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<__u64>(message);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data;
+    return true;
+}
+
+void IoUring::recycle_buffer(const unsigned short buffer_id) noexcept {
+    auto& buffer = buffer_ring[buffer_ring_tail & (buffer_count - 1)];
+    buffer.addr = reinterpret_cast<__u64>(buffers.data() + buffer_id * buffer_size);
+    buffer.len = buffer_size;
+    buffer.bid = buffer_id;
+
+    // The ring tail overlays the reserved field of the first entry (see io_uring_buf_ring). The
+    // struct itself is not used since its flexible array member is laid out differently in C++.
+    __atomic_store_n(&buffer_ring[0].resv, ++buffer_ring_tail, __ATOMIC_RELEASE);
+}
+
+void IoUring::release() noexcept {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+
+    if (sqes != MAP_FAILED) {
+        munmap(sqes, sqes_size);
+        sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    }
+
+    if (ring != MAP_FAILED) {
+        munmap(ring, ring_size);
+        ring = MAP_FAILED;
+    }
+
+    if (buffer_ring != nullptr) {
+        munmap(buffer_ring, buffer_ring_size);
+        buffer_ring = nullptr;
+    }
+}
+
+void IoUring::setup(const unsigned entries) {
+    io_uring_params params = {};
+    fd = syscall(__NR_io_uring_setup, entries, &params);
+
+    if (fd == -1) {
+        throw errno_to_system_error("Failed to set up io_uring");
+    }
+
+    const auto required_features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+
+    if ((params.features & required_features) != required_features) {
+        throw system_error(ENOTSUP, system_category(), "io_uring lacks required features");
+    }
+
+    ring_size = max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                    params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    ring = mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+
+    if (ring == MAP_FAILED) {
+        throw errno_to_system_error("Failed to map io_uring rings");
+    }
+
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+
+    if (sqes == MAP_FAILED) {
+        throw errno_to_system_error("Failed to map io_uring submission entries");
+    }
+
+    auto ring_bytes = static_cast<unsigned char*>(ring);
+    sq_head = reinterpret_cast<unsigned*>(ring_bytes + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(ring_bytes + params.sq_off.tail);
+    sq_ring_mask = reinterpret_cast<unsigned*>(ring_bytes + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(ring_bytes + params.sq_off.array);
+    sq_entries = params.sq_entries;
+    sq_local_tail = *sq_tail;
+
+    cq_head = reinterpret_cast<unsigned*>(ring_bytes + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(ring_bytes + params.cq_off.tail);
+    cq_ring_mask = reinterpret_cast<unsigned*>(ring_bytes + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(ring_bytes + params.cq_off.cqes);
+
+    // Make sure every operation the reactor submits is known to the kernel.
+
+    const unsigned probe_ops = 256;
+    vector<unsigned char> probe_storage(sizeof(io_uring_probe) + probe_ops * sizeof(io_uring_probe_op));
+    auto probe = reinterpret_cast<io_uring_probe*>(probe_storage.data());
+
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, probe_ops) == -1) {
+        throw errno_to_system_error("Failed to probe io_uring operations");
+    }
+
+    for (const auto op : { IORING_OP_ACCEPT, IORING_OP_READ, IORING_OP_RECV, IORING_OP_SENDMSG }) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            throw system_error(ENOTSUP, system_category(), "io_uring lacks required operations");
+        }
+    }
+}
+
+void IoUring::setup_buffer_ring() {
+    buffer_ring_size = buffer_count * sizeof(io_uring_buf);
+    auto memory = mmap(nullptr, buffer_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED) {
+        throw errno_to_system_error("Failed to allocate io_uring buffer ring");
+    }
+
+    buffer_ring = static_cast<io_uring_buf*>(memory);
+
+    io_uring_buf_reg registration = {};
+    registration.ring_addr = reinterpret_cast<__u64>(buffer_ring);
+    registration.ring_entries = buffer_count;
+    registration.bgid = buffer_group;
+
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PBUF_RING, &registration, 1) == -1) {
+        throw errno_to_system_error("Failed to register io_uring buffer ring");
+    }
+
+    buffers.resize(buffer_count * buffer_size);
+
+    for (unsigned buffer_id{0}; buffer_id < buffer_count; ++buffer_id) {
+        recycle_buffer(buffer_id);
+    }
+}
+
+void IoUring::submit_and_wait(const int timeout) {
+    enter(timeout == 0 ? 0 : 1, timeout);
+}
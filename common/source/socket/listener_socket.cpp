@@ -0,0 +1,204 @@
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <exception.hpp>
+#include <socket/address.hpp>
+#include <socket/listener_socket.hpp>
+
+using namespace std;
+
+SocketOptions::SocketOptions() noexcept :
+    busy_poll(0),
+    defer_accept(0),
+    no_delay(true),
+    not_sent_low_water_mark(0),
+    receive_buffer_size(0),
+    send_buffer_size(0)
+{
+
+}
+
+ListenerSocket::ListenerSocket(const int fd, const sockaddr_storage& address, const socklen_t address_size) noexcept :
+    Socket(fd, false),
+    address(address),
+    address_size(address_size),
+    is_path_owner(false)
+{
+
+}
+
+ListenerSocket::ListenerSocket(const addrinfo& address) :
+    Socket(address.ai_family, address.ai_socktype, address.ai_protocol),
+    address(),
+    address_size(address.ai_addrlen),
+    is_path_owner(false)
+{
+    memcpy(&this->address, address.ai_addr, address.ai_addrlen);
+
+    // IPv6 sockets would otherwise also claim the IPv4 port, which has a socket of its own.
+    if (address.ai_family == AF_INET6) {
+        const int value = 1;
+
+        if (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &value, sizeof(value)) == -1) {
+            throw errno_to_system_error("Failed to set IPv6 only for socket");
+        }
+    }
+}
+
+ListenerSocket::ListenerSocket(const string& path) :
+    Socket(AF_UNIX, SOCK_STREAM, 0),
+    address(),
+    address_size(0),
+    is_path_owner(false)
+{
+    auto& address_un = reinterpret_cast<sockaddr_un&>(address);
+
+    if (path.empty() || path.size() >= sizeof(address_un.sun_path)) {
+        throw system_error(ENAMETOOLONG, system_category(), "Invalid Unix domain socket path \"" + path + "\"");
+    }
+
+    address_un.sun_family = AF_UNIX;
+    memcpy(address_un.sun_path, path.c_str(), path.size() + 1);
+    address_size = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+}
+
+ListenerSocket::ListenerSocket(ListenerSocket&& other) noexcept :
+    Socket(move(other)),
+    address(other.address),
+    address_size(other.address_size),
+    is_path_owner(other.is_path_owner)
+{
+    other.is_path_owner = false;
+}
+
+ListenerSocket::~ListenerSocket() {
+    if (is_path_owner) {
+        unlink(reinterpret_cast<const sockaddr_un&>(address).sun_path);
+    }
+}
+
+vector<ListenerSocket> ListenerSocket::resolve(const string& host, const string& port) {
+    addrinfo* addresses;
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_flags = AI_PASSIVE;
+    hints.ai_socktype = SOCK_STREAM;
+
+    const auto result = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addresses);
+
+    if (result != 0) {
+        throw AddrInfoException(result, "Failed to get address information");
+    }
+
+    unique_ptr<addrinfo, void (*)(addrinfo*)> addresses_guard(addresses, freeaddrinfo);
+    vector<ListenerSocket> listeners;
+
+    for (auto address = addresses; address != nullptr; address = address->ai_next) {
+        try {
+            listeners.emplace_back(*address);
+        } catch (const system_error& error) {
+            if (error.code().value() != EAFNOSUPPORT) {
+                throw;
+            }
+        }
+    }
+
+    if (listeners.empty()) {
+        throw system_error(EAFNOSUPPORT, system_category(), "Failed to create socket for any address of \"" + host + "\"");
+    }
+
+    return listeners;
+}
+
+void ListenerSocket::bind() {
+    if (address.ss_family == AF_UNIX) {
+        const auto path = reinterpret_cast<const sockaddr_un&>(address).sun_path;
+        struct stat status;
+
+        if (lstat(path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+            unlink(path);
+        }
+    }
+
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), address_size) == -1) {
+        throw errno_to_system_error("Failed to bind address to socket");
+    }
+
+    is_path_owner = address.ss_family == AF_UNIX;
+}
+
+ListenerSocket ListenerSocket::duplicate() const {
+    const auto duplicate_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+
+    if (duplicate_fd == -1) {
+        throw errno_to_system_error("Failed to duplicate socket");
+    }
+
+    return ListenerSocket(duplicate_fd, address, address_size);
+}
+
+int ListenerSocket::get_family() const noexcept {
+    return address.ss_family;
+}
+
+string ListenerSocket::get_name() const {
+    string name;
+    string port;
+    format_address(address, address_size, name, port);
+
+    switch (address.ss_family) {
+        case AF_INET6:
+            return "[" + name + "]:" + port;
+
+        case AF_UNIX:
+            return name;
+
+        default:
+            return name + ":" + port;
+    }
+}
+
+void ListenerSocket::listen(const size_t max_pending_connections) const {
+    if (::listen(fd, max_pending_connections) == -1) {
+        throw errno_to_system_error("Failed to set socket as listening");
+    }
+}
+
+void ListenerSocket::set_options(const SocketOptions& options) {
+    assert(address.ss_family == AF_INET || address.ss_family == AF_INET6);
+
+    if (options.busy_poll.count() > 0) {
+        set_busy_poll(options.busy_poll);
+    }
+
+    if (options.defer_accept.count() > 0) {
+        set_defer_accept(options.defer_accept);
+    }
+
+    set_no_delay(options.no_delay);
+
+    if (options.not_sent_low_water_mark > 0) {
+        set_not_sent_low_water_mark(options.not_sent_low_water_mark);
+    }
+
+    // Buffer sizes have to be set before listen to take effect on the window scaling of
+    // connections.
+    if (options.receive_buffer_size > 0) {
+        set_receive_buffer_size(options.receive_buffer_size);
+    }
+
+    if (options.send_buffer_size > 0) {
+        set_send_buffer_size(options.send_buffer_size);
+    }
+}
@@ -1,107 +1,181 @@
-#include <cassert>
-
-#include <fcntl.h>
-#include <sys/socket.h>
-#include <sys/types.h>
-#include <unistd.h>
-
-#include <exception.hpp>
-#include <socket/socket.hpp>
-
-using namespace std;
-
-Socket::Socket() noexcept :
-    non_blocking(false),
-    reuse_address(false),
-    fd(-1)
-{
-
-}
-
-Socket::Socket(const int fd) noexcept : 
-    non_blocking(false),
-    fd(fd)
-{
-    assert(fd >= 0);
-}
-
-Socket::Socket(const int domain, const int type, const int protocol) :
-    non_blocking(false),
-    fd(socket(domain, type, protocol))
-{
-    if (fd == -1) {
-        throw errno_to_system_error("Failed to create socket");
-    }
-}
-
-Socket::Socket(Socket&& other) noexcept :
-    non_blocking(other.non_blocking),
-    reuse_address(other.reuse_address),
-    fd(other.fd)
-{
-    other.fd = -1;
-}
-
-Socket& Socket::operator=(Socket&& other) noexcept {
-    non_blocking = other.non_blocking;
-    reuse_address = other.reuse_address;
-    fd = other.fd;
-
-    other.fd = -1;
-
-    return *this;
-}
-
-Socket::~Socket() {
-    if (fd >= 0) {
-        // TODO: Handle close error
-        
-        close(fd);
-    }
-}
-
-int Socket::get_fd() const noexcept {
-    return fd;
-}
-
-bool Socket::is_non_blocking() const noexcept {
-    return non_blocking;
-}
-
-bool Socket::is_reuse_address() const noexcept {
-    return reuse_address;
-}
-
-void Socket::set_non_blocking(const bool non_blocking) {
-    if (this->non_blocking == non_blocking) {
-        return;
-    }
-
-    auto flags = fcntl(fd, F_GETFL, 0);
-
-    if (flags == -1) {
-        throw errno_to_system_error("Failed to get status flags for socket");
-    }
-
-    if (non_blocking) {
-        flags |= O_NONBLOCK;
-    } else {
-        flags &= ~O_NONBLOCK;
-    }
-
-    if (fcntl(fd, F_SETFL, flags) == -1) {
-        throw errno_to_system_error("Failed to set non-blocking flag for socket");
-    }
-
-    this->non_blocking = non_blocking;
-}
-
-void Socket::set_reuse_address(const bool reuse_address) {
-    auto value = static_cast<int>(reuse_address);
-
-    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value)) == -1) {
-        throw errno_to_system_error("Failed to set reuse address for socket");
-    }
-
-    this->reuse_address = reuse_address;
-}
+#include <cassert>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <exception.hpp>
+#include <socket/socket.hpp>
+
+using namespace std;
+
+namespace {
+    int get_int_option(const int fd, const int level, const int name, const char* const what_arg) {
+        int value;
+        socklen_t value_size = sizeof(value);
+
+        if (getsockopt(fd, level, name, &value, &value_size) == -1) {
+            throw errno_to_system_error(what_arg);
+        }
+
+        return value;
+    }
+
+    void set_int_option(const int fd, const int level, const int name, const int value, const char* const what_arg) {
+        if (setsockopt(fd, level, name, &value, sizeof(value)) == -1) {
+            throw errno_to_system_error(what_arg);
+        }
+    }
+}
+
+Socket::Socket() noexcept :
+    non_blocking(false),
+    reuse_address(false),
+    reuse_port(false),
+    fd(-1)
+{
+
+}
+
+Socket::Socket(const int fd, const bool non_blocking) noexcept : 
+    non_blocking(non_blocking),
+    reuse_address(false),
+    reuse_port(false),
+    fd(fd)
+{
+    assert(fd >= 0);
+}
+
+Socket::Socket(const int domain, const int type, const int protocol) :
+    non_blocking(false),
+    reuse_address(false),
+    reuse_port(false),
+    fd(socket(domain, type, protocol))
+{
+    if (fd == -1) {
+        throw errno_to_system_error("Failed to create socket");
+    }
+}
+
+Socket::Socket(Socket&& other) noexcept :
+    non_blocking(other.non_blocking),
+    reuse_address(other.reuse_address),
+    reuse_port(other.reuse_port),
+    fd(other.fd)
+{
+    other.fd = -1;
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept {
+    non_blocking = other.non_blocking;
+    reuse_address = other.reuse_address;
+    reuse_port = other.reuse_port;
+    fd = other.fd;
+
+    other.fd = -1;
+
+    return *this;
+}
+
+Socket::~Socket() {
+    if (fd >= 0) {
+        // TODO: Handle close error
+        
+        close(fd);
+    }
+}
+
+int Socket::get_fd() const noexcept {
+    return fd;
+}
+
+int Socket::get_receive_buffer_size() const {
+    return get_int_option(fd, SOL_SOCKET, SO_RCVBUF, "Failed to get receive buffer size for socket");
+}
+
+int Socket::get_send_buffer_size() const {
+    return get_int_option(fd, SOL_SOCKET, SO_SNDBUF, "Failed to get send buffer size for socket");
+}
+
+bool Socket::is_non_blocking() const noexcept {
+    return non_blocking;
+}
+
+bool Socket::is_reuse_address() const noexcept {
+    return reuse_address;
+}
+
+bool Socket::is_reuse_port() const noexcept {
+    return reuse_port;
+}
+
+void Socket::set_busy_poll(const chrono::microseconds timeout) {
+    set_int_option(fd, SOL_SOCKET, SO_BUSY_POLL, static_cast<int>(timeout.count()), "Failed to set busy poll for socket");
+}
+
+void Socket::set_defer_accept(const chrono::seconds timeout) {
+    set_int_option(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, static_cast<int>(timeout.count()), "Failed to set defer accept for socket");
+}
+
+void Socket::set_no_delay(const bool no_delay) {
+    set_int_option(fd, IPPROTO_TCP, TCP_NODELAY, static_cast<int>(no_delay), "Failed to set no delay for socket");
+}
+
+void Socket::set_non_blocking(const bool non_blocking) {
+    if (this->non_blocking == non_blocking) {
+        return;
+    }
+
+    auto flags = fcntl(fd, F_GETFL, 0);
+
+    if (flags == -1) {
+        throw errno_to_system_error("Failed to get status flags for socket");
+    }
+
+    if (non_blocking) {
+        flags |= O_NONBLOCK;
+    } else {
+        flags &= ~O_NONBLOCK;
+    }
+
+    if (fcntl(fd, F_SETFL, flags) == -1) {
+        throw errno_to_system_error("Failed to set non-blocking flag for socket");
+    }
+
+    this->non_blocking = non_blocking;
+}
+
+void Socket::set_not_sent_low_water_mark(const int size) {
+    set_int_option(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, size, "Failed to set not sent low water mark for socket");
+}
+
+void Socket::set_receive_buffer_size(const int size) {
+    set_int_option(fd, SOL_SOCKET, SO_RCVBUF, size, "Failed to set receive buffer size for socket");
+}
+
+void Socket::set_reuse_address(const bool reuse_address) {
+    auto value = static_cast<int>(reuse_address);
+
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value)) == -1) {
+        throw errno_to_system_error("Failed to set reuse address for socket");
+    }
+
+    this->reuse_address = reuse_address;
+}
+
+void Socket::set_reuse_port(const bool reuse_port) {
+    auto value = static_cast<int>(reuse_port);
+
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value)) == -1) {
+        throw errno_to_system_error("Failed to set reuse port for socket");
+    }
+
+    this->reuse_port = reuse_port;
+}
+
+void Socket::set_send_buffer_size(const int size) {
+    set_int_option(fd, SOL_SOCKET, SO_SNDBUF, size, "Failed to set send buffer size for socket");
+}
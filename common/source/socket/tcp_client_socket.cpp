@@ -1,83 +1,301 @@
-#include <netdb.h>
-#include <sys/socket.h>
-#include <sys/types.h>
-
-#include <exception.hpp>
-#include <socket/tcp_client_socket.hpp>
-
-using namespace std;
-
-TCPClientSocket::TCPClientSocket(string address, string port, const int fd) noexcept :
-    Socket(fd),
-    address(address),
-    port(port)
-{
-    
-}
-
-TCPClientSocket::TCPClientSocket(string address, string port) :
-    Socket(),
-    address(address),
-    port(port)
-{
-    addrinfo* addresses;
-    addrinfo hints = {};
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-
-    const auto result = getaddrinfo(address.c_str(), port.c_str(), &hints, &addresses);
-
-    if (result != 0) {
-        throw AddrInfoException(result, "Failed to get address information");
-    }
-
-    fd = socket(addresses->ai_family,
-                addresses->ai_socktype,
-                addresses->ai_protocol);
-
-    if (fd == -1) {
-        freeaddrinfo(addresses);
-        throw errno_to_system_error("Failed to create socket");
-    }
-
-    if (connect(fd, addresses->ai_addr, addresses->ai_addrlen) == -1) {
-        freeaddrinfo(addresses);
-        throw errno_to_system_error("Failed to connect to address");
-    }
-}
-
-bool TCPClientSocket::recv(unsigned char* const buffer, size_t& size) {
-    if (size == 0) {
-        return false;
-    }
-
-    const auto total_size = size;
-
-    while (size > 0) {
-        auto bytes_received = ::recv(fd, buffer + total_size - size, size, 0);
-
-        if (bytes_received == -1) {
-            throw errno_to_system_error("Failed to receive data from socket");
-        } else if (bytes_received == 0) {
-            return true;
-        } else {
-            size -= bytes_received;
-        }
-    }
-
-    return false;
-}
-
-void TCPClientSocket::send(const unsigned char* const buffer, size_t& size) {
-    size_t total_size = size;
-
-    while (size > 0) {
-        auto bytes_written = ::send(fd, buffer + total_size - size, size, 0);
-
-        if (bytes_written == -1) {
-            throw errno_to_system_error("Failed to write data to socket");
-        } else {
-            size -= bytes_written;
-        }
-    }
-}
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include <linux/errqueue.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+
+#include <exception.hpp>
+#include <socket/address.hpp>
+#include <socket/tcp_client_socket.hpp>
+
+using namespace std;
+
+namespace {
+    IoStatus to_io_status(const int error) noexcept {
+        switch (error) {
+            case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+            case EWOULDBLOCK:
+#endif
+                return IoStatus::WouldBlock;
+
+            case ECONNRESET:
+            case ENOTCONN:
+            case EPIPE:
+                return IoStatus::PeerClosed;
+
+            default:
+                return IoStatus::Error;
+        }
+    }
+}
+
+TCPClientSocket::TCPClientSocket(const int fd, const sockaddr_storage& peer_address, const socklen_t peer_address_size, const bool non_blocking) noexcept :
+    Socket(fd, non_blocking),
+    address(),
+    port(),
+    peer_address(peer_address),
+    peer_address_size(peer_address_size)
+{
+    
+}
+
+TCPClientSocket::TCPClientSocket(string address, string port) :
+    Socket(),
+    address(address),
+    port(port),
+    peer_address(),
+    peer_address_size(0)
+{
+    addrinfo* addresses;
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    const auto result = getaddrinfo(address.c_str(), port.c_str(), &hints, &addresses);
+
+    if (result != 0) {
+        throw AddrInfoException(result, "Failed to get address information");
+    }
+
+    fd = socket(addresses->ai_family,
+                addresses->ai_socktype,
+                addresses->ai_protocol);
+
+    if (fd == -1) {
+        freeaddrinfo(addresses);
+        throw errno_to_system_error("Failed to create socket");
+    }
+
+    if (connect(fd, addresses->ai_addr, addresses->ai_addrlen) == -1) {
+        freeaddrinfo(addresses);
+        throw errno_to_system_error("Failed to connect to address");
+    }
+}
+
+TCPClientSocket::TCPClientSocket(string path) :
+    Socket(AF_UNIX, SOCK_STREAM, 0),
+    address(path),
+    port(),
+    peer_address(),
+    peer_address_size(0)
+{
+    sockaddr_un address_un = {};
+
+    if (path.empty() || path.size() >= sizeof(address_un.sun_path)) {
+        throw system_error(ENAMETOOLONG, system_category(), "Invalid Unix domain socket path \"" + path + "\"");
+    }
+
+    address_un.sun_family = AF_UNIX;
+    memcpy(address_un.sun_path, path.c_str(), path.size() + 1);
+
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address_un), offsetof(sockaddr_un, sun_path) + path.size() + 1) == -1) {
+        throw errno_to_system_error("Failed to connect to address");
+    }
+}
+
+void TCPClientSocket::format_peer_address(string& address, string& port) const {
+    if (peer_address_size > 0) {
+        format_address(peer_address, peer_address_size, address, port);
+        return;
+    }
+
+    sockaddr_storage queried_address;
+    socklen_t queried_address_size = sizeof(queried_address);
+
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&queried_address), &queried_address_size) == -1) {
+        throw errno_to_system_error("Failed to get peer address of socket");
+    }
+
+    format_address(queried_address, queried_address_size, address, port);
+}
+
+bool TCPClientSocket::enable_zero_copy() {
+    const int value = 1;
+
+    if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &value, sizeof(value)) == -1) {
+        if (errno == EOPNOTSUPP) {
+            return false;
+        }
+
+        throw errno_to_system_error("Failed to enable zero-copy for socket");
+    }
+
+    return true;
+}
+
+string TCPClientSocket::get_address() const {
+    if (!this->address.empty()) {
+        return this->address;
+    }
+
+    string address;
+    string port;
+    format_peer_address(address, port);
+
+    return address;
+}
+
+string TCPClientSocket::get_port() const {
+    if (!this->port.empty()) {
+        return this->port;
+    }
+
+    string address;
+    string port;
+    format_peer_address(address, port);
+
+    return port;
+}
+
+bool TCPClientSocket::recv(unsigned char* const buffer, size_t& size) {
+    if (size == 0) {
+        return false;
+    }
+
+    const auto total_size = size;
+
+    while (size > 0) {
+        auto bytes_received = ::recv(fd, buffer + total_size - size, size, 0);
+
+        if (bytes_received == -1) {
+            throw errno_to_system_error("Failed to receive data from socket");
+        } else if (bytes_received == 0) {
+            return true;
+        } else {
+            size -= bytes_received;
+        }
+    }
+
+    return false;
+}
+
+void TCPClientSocket::send(const unsigned char* const buffer, size_t& size) {
+    size_t total_size = size;
+
+    while (size > 0) {
+        auto bytes_written = ::send(fd, buffer + total_size - size, size, 0);
+
+        if (bytes_written == -1) {
+            throw errno_to_system_error("Failed to write data to socket");
+        } else {
+            size -= bytes_written;
+        }
+    }
+}
+
+IoResult TCPClientSocket::try_recv(unsigned char* const buffer, const size_t size) noexcept {
+    if (size == 0) {
+        return IoResult{IoStatus::Complete, 0, 0};
+    }
+
+    while (true) {
+        const auto bytes_received = ::recv(fd, buffer, size, 0);
+
+        if (bytes_received > 0) {
+            return IoResult{IoStatus::Complete, static_cast<size_t>(bytes_received), 0};
+        }
+
+        if (bytes_received == 0) {
+            return IoResult{IoStatus::PeerClosed, 0, 0};
+        }
+
+        if (errno != EINTR) {
+            return IoResult{to_io_status(errno), 0, errno};
+        }
+    }
+}
+
+IoResult TCPClientSocket::try_send(iovec* vectors, size_t count) noexcept {
+    size_t size = 0;
+
+    while (count > 0) {
+        auto bytes_written = ::writev(fd, vectors, static_cast<int>(count));
+
+        if (bytes_written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return IoResult{to_io_status(errno), size, errno};
+        }
+
+        size += bytes_written;
+
+        while (count > 0 && static_cast<size_t>(bytes_written) >= vectors->iov_len) {
+            bytes_written -= vectors->iov_len;
+            ++vectors;
+            --count;
+        }
+
+        if (count > 0) {
+            vectors->iov_base = static_cast<unsigned char*>(vectors->iov_base) + bytes_written;
+            vectors->iov_len -= bytes_written;
+        }
+    }
+
+    return IoResult{IoStatus::Complete, size, 0};
+}
+
+IoResult TCPClientSocket::try_send_zero_copy(const iovec* const vectors, const size_t count) noexcept {
+    msghdr message = {};
+    message.msg_iov = const_cast<iovec*>(vectors);
+    message.msg_iovlen = count;
+
+    while (true) {
+        const auto bytes_written = ::sendmsg(fd, &message, MSG_NOSIGNAL | MSG_ZEROCOPY);
+
+        if (bytes_written >= 0) {
+            return IoResult{IoStatus::Complete, static_cast<size_t>(bytes_written), 0};
+        }
+
+        if (errno != EINTR) {
+            return IoResult{to_io_status(errno), 0, errno};
+        }
+    }
+}
+
+bool TCPClientSocket::take_zero_copy_completion(uint32_t& first, uint32_t& last, bool& copied) {
+    // Other errors queued for the socket, which it does not ask for, are skipped.
+    while (true) {
+        alignas(cmsghdr) unsigned char control[CMSG_SPACE(sizeof(sock_extended_err)) * 2];
+        msghdr message = {};
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if (::recvmsg(fd, &message, MSG_ERRQUEUE) == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return false;
+            }
+
+            throw errno_to_system_error("Failed to receive from error queue of socket");
+        }
+
+        for (auto header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+            if (!(header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR)
+                && !(header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR)) {
+                continue;
+            }
+
+            sock_extended_err error;
+            memcpy(&error, CMSG_DATA(header), sizeof(error));
+
+            if (error.ee_origin != SO_EE_ORIGIN_ZEROCOPY || error.ee_errno != 0) {
+                continue;
+            }
+
+            first = error.ee_info;
+            last = error.ee_data;
+            copied = (error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+
+            return true;
+        }
+    }
+}
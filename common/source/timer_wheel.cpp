@@ -0,0 +1,179 @@
+#include <cassert>
+#include <climits>
+
+#include <timer_wheel.hpp>
+
+using namespace std;
+
+constexpr unsigned TimerWheel::level_bits;
+constexpr size_t TimerWheel::levels;
+constexpr size_t TimerWheel::slots_per_level;
+constexpr TimerWheel::TimerID TimerWheel::invalid_id;
+
+TimerWheel::TimerWheel(const Clock::duration resolution) :
+    start(Clock::now()),
+    resolution(resolution),
+    current_tick(0),
+    number_of_timers(0),
+    occupied_slots(),
+    slots(),
+    timers()
+{
+    assert(resolution > Clock::duration::zero());
+
+    for (auto& level : slots) {
+        level.fill(invalid_id);
+    }
+}
+
+void TimerWheel::arm(const TimerID id, const Clock::time_point deadline) {
+    assert(id != invalid_id);
+
+    if (deadline == Clock::time_point::max()) {
+        cancel(id);
+        return;
+    }
+
+    if (id >= timers.size()) {
+        timers.resize(static_cast<size_t>(id) + 1, Timer{0, invalid_id, invalid_id, 0, 0, false});
+    }
+
+    if (timers[id].is_armed) {
+        unlink(id);
+    }
+
+    timers[id].expiry_tick = deadline > start ? static_cast<uint64_t>((deadline - start + resolution - Clock::duration(1)) / resolution) : 0;
+    link(id, current_tick + 1);
+}
+
+void TimerWheel::cancel(const TimerID id) noexcept {
+    if (id < timers.size() && timers[id].is_armed) {
+        unlink(id);
+    }
+}
+
+// Timers in the slot of a higher level whose period starts at the current tick are moved down to
+// the level matching their remaining time. Higher levels go first so their timers can cascade
+// all the way down to level 0.
+void TimerWheel::cascade() noexcept {
+    for (auto level = levels - 1; level > 0; --level) {
+        const auto shift = level * level_bits;
+
+        if ((current_tick & ((uint64_t{1} << shift) - 1)) != 0) {
+            continue;
+        }
+
+        auto& slot = slots[level][(current_tick >> shift) & (slots_per_level - 1)];
+
+        while (slot != invalid_id) {
+            const auto id = slot;
+            unlink(id);
+            link(id, current_tick);
+        }
+    }
+}
+
+int TimerWheel::get_timeout(const Clock::time_point now, const int timeout) const noexcept {
+    if (number_of_timers == 0) {
+        return timeout;
+    }
+
+    const auto next = start + resolution * get_next_tick();
+
+    if (next <= now) {
+        return 0;
+    }
+
+    const auto milliseconds = chrono::duration_cast<chrono::milliseconds>(next - now + chrono::milliseconds(1) - Clock::duration(1)).count();
+    const auto next_timeout = milliseconds < INT_MAX ? static_cast<int>(milliseconds) : INT_MAX;
+
+    return timeout >= 0 && timeout < next_timeout ? timeout : next_timeout;
+}
+
+// Each occupied slot lies within one revolution ahead of the current slot of its level, so the
+// first occupied slot after the current one gives the next tick at which the level needs work.
+uint64_t TimerWheel::get_next_tick() const noexcept {
+    auto next_tick = numeric_limits<uint64_t>::max();
+
+    for (size_t level{0}; level < levels; ++level) {
+        if (occupied_slots[level] == 0) {
+            continue;
+        }
+
+        const auto shift = level * level_bits;
+        const auto current_period = current_tick >> shift;
+        const auto rotation = (current_period + 1) & (slots_per_level - 1);
+        const auto occupied = rotation == 0 ? occupied_slots[level] : occupied_slots[level] >> rotation | occupied_slots[level] << (slots_per_level - rotation);
+        const auto tick = (current_period + 1 + __builtin_ctzll(occupied)) << shift;
+
+        if (tick < next_tick) {
+            next_tick = tick;
+        }
+    }
+
+    return next_tick;
+}
+
+void TimerWheel::link(const TimerID id, const uint64_t earliest_tick) noexcept {
+    auto& timer = timers[id];
+    const auto expiry_tick = timer.expiry_tick > earliest_tick ? timer.expiry_tick : earliest_tick;
+    auto level = levels;
+    size_t slot = 0;
+
+    // The lowest level whose slots still reach the expiry within one revolution.
+    for (size_t i{0}; i < levels; ++i) {
+        const auto shift = i * level_bits;
+
+        if ((expiry_tick >> shift) - (current_tick >> shift) < slots_per_level) {
+            level = i;
+            slot = (expiry_tick >> shift) & (slots_per_level - 1);
+            break;
+        }
+    }
+
+    // Beyond the range of the wheel: park the timer in the last slot of the top level, from where
+    // it is cascaded and placed again once that slot comes around.
+    if (level == levels) {
+        level = levels - 1;
+        slot = ((current_tick >> (level * level_bits)) + slots_per_level - 1) & (slots_per_level - 1);
+    }
+
+    auto& head = slots[level][slot];
+
+    timer.level = static_cast<unsigned char>(level);
+    timer.slot = static_cast<unsigned char>(slot);
+    timer.previous = invalid_id;
+    timer.next = head;
+    timer.is_armed = true;
+
+    if (head != invalid_id) {
+        timers[head].previous = id;
+    }
+
+    head = id;
+    occupied_slots[level] |= uint64_t{1} << slot;
+    ++number_of_timers;
+}
+
+void TimerWheel::unlink(const TimerID id) noexcept {
+    auto& timer = timers[id];
+    assert(timer.is_armed);
+
+    if (timer.previous != invalid_id) {
+        timers[timer.previous].next = timer.next;
+    } else {
+        auto& head = slots[timer.level][timer.slot];
+        head = timer.next;
+
+        if (head == invalid_id) {
+            occupied_slots[timer.level] &= ~(uint64_t{1} << timer.slot);
+        }
+    }
+
+    if (timer.next != invalid_id) {
+        timers[timer.next].previous = timer.previous;
+    }
+
+    timer.is_armed = false;
+    --number_of_timers;
+}
@@ -1,54 +1,89 @@
-#pragma once
-
-#include <cstddef>
-#include <exception>
-#include <string>
-#include <unordered_map>
-#include <unordered_set>
-#include <vector>
-
-#include <chat_user.hpp>
-
-namespace protocol {
-    class State;
-}
-
-class IncorrectPasswordException: public std::exception {
-public:
-    virtual const char* what() const noexcept override;
-};
-
-class UserAlreadyRegisteredException: public std::exception {
-public:
-    virtual const char* what() const noexcept override;
-};
-
-class UserDoesNotExistException: public std::exception {
-public:
-    virtual const char* what() const noexcept override;
-};
-
-class ChatApp {
-private:
-    ChatUserID user_sequence_number;
-    std::unordered_map<std::string, ChatUserProfile> user_profiles;
-    std::unordered_map<ChatUserID, ChatUser> users_online;
-
-public:
-    ChatApp() = default;
-    ChatApp(ChatApp const &) = delete;
-    ChatApp(ChatApp&&) = default;
-    ChatApp& operator=(const ChatApp&) = delete;
-    ChatApp& operator=(ChatApp&&) = default;
-
-    std::vector<std::string> get_online_user_list() const;
-    const ChatUserProfile& get_user_profile(const ChatUserID user_id) const;
-    ChatUserProfile& get_user_profile(std::string name);
-    ChatUserID login(protocol::State& protocol_state, const std::string& name, const std::string& password);
-    void logout(const ChatUserID user_id);
-    void register_user(std::string name, std::string password);
-    void send_anonymous_message(const ChatUserID user_id, const std::string& message);
-    bool send_anonymous_private_message(const ChatUserID user_id, const std::string& name, const std::string& message);
-    void send_message(const ChatUserID user_id, const std::string& message);
-    bool send_private_message(const ChatUserID user_id, const std::string& name, const std::string& message);
-};
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <arena.hpp>
+#include <chat_user.hpp>
+#include <flat_hash_map.hpp>
+#include <protocol/outbound_queue.hpp>
+#include <protocol/packed_name.hpp>
+#include <string_view.hpp>
+
+namespace protocol {
+    class State;
+}
+
+class Reactor;
+
+class IncorrectPasswordException: public std::exception {
+public:
+    virtual const char* what() const noexcept override;
+};
+
+class UserAlreadyRegisteredException: public std::exception {
+public:
+    virtual const char* what() const noexcept override;
+};
+
+class UserDoesNotExistException: public std::exception {
+public:
+    virtual const char* what() const noexcept override;
+};
+
+// Shared by every reactor thread. All members are guarded by the mutex, and messages for users
+// on another reactor are handed to that reactor as a task instead of being written directly.
+class ChatApp {
+private:
+    mutable std::mutex mutex;
+    ChatUserID user_sequence_number;
+    // Profiles are never removed, and a deque keeps them in place as it grows, so users and name
+    // views can refer to them. They are indexed by case folded name, as names are unique
+    // regardless of case.
+    std::deque<ChatUserProfile> profiles;
+    FlatHashMap<protocol::UserName, ChatUserProfile*> user_profiles;
+    FlatHashMap<ChatUserID, ChatUser> users_online;
+    // The sessions of every online user by exact name.
+    FlatHashMap<protocol::UserName, std::vector<ChatUserID>> sessions_by_name;
+
+    // The recipients of a message are collected under the lock and only delivered to once it has
+    // been released, so that a fan-out does not hold up the other reactors. Users on the current
+    // reactor can only log out on its own thread, so their states stay valid until then; users
+    // on other reactors are delivered to by a task posted to theirs.
+    struct Recipients {
+        std::vector<protocol::State*> local_states;
+        std::unordered_map<Reactor*, std::vector<ChatUserID>> remote_user_ids;
+    };
+
+    void collect(const ChatUser& user, Recipients& recipients) const;
+    void collect_online_users(const ChatUserID user_id, Recipients& recipients) const;
+    bool collect_sessions(const ChatUserID user_id, const StringView name, Recipients& recipients) const;
+    void deliver(Recipients& recipients, const protocol::SharedFrame& frame);
+    const ChatUserProfile& find_user_profile(const ChatUserID user_id) const;
+    ChatUserProfile& find_user_profile(const StringView name);
+
+    static Recipients& get_recipients();
+
+public:
+    ChatApp() = default;
+    ChatApp(ChatApp const &) = delete;
+    ChatApp(ChatApp&&) = delete;
+    ChatApp& operator=(const ChatApp&) = delete;
+    ChatApp& operator=(ChatApp&&) = delete;
+
+    // Returns the distinct names of the online users in order, allocated from the arena.
+    ArenaVector<StringView> get_online_user_list(Arena& arena) const;
+    const ChatUserProfile& get_user_profile(const ChatUserID user_id) const;
+    ChatUserProfile& get_user_profile(const StringView name);
+    ChatUserID login(protocol::State& protocol_state, const StringView name, const StringView password);
+    void logout(const ChatUserID user_id);
+    void register_user(const StringView name, const StringView password);
+    void send_anonymous_message(const ChatUserID user_id, const StringView message);
+    bool send_anonymous_private_message(const ChatUserID user_id, const StringView name, const StringView message);
+    void send_message(const ChatUserID user_id, const StringView message);
+    bool send_private_message(const ChatUserID user_id, const StringView name, const StringView message);
+};
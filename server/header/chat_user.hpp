@@ -1,45 +1,53 @@
-#pragma once
-
-#include <cstddef>
-#include <string>
-
-class ChatUserProfile;
-
-namespace protocol {
-    class State;
-}
-
-using ChatUserID = std::size_t;
-
-class ChatUser {
-private:
-    const ChatUserID id;
-    const ChatUserProfile& profile;
-    protocol::State& protocol_state;
-
-public:
-    ChatUser(const ChatUserProfile& profile, protocol::State& protocol_state, const ChatUserID id) noexcept;
-    ChatUser(ChatUser const &) = delete;
-    ChatUser(ChatUser&&) = default;
-    ChatUser& operator=(const ChatUser&) = delete;
-    ChatUser& operator=(ChatUser&&) = default;
-
-    ChatUserID get_id() const noexcept;
-    const ChatUserProfile& get_profile() const noexcept;
-    void send_anonymous_message(const std::string& message);
-    void send_anonymous_private_message(const std::string& message);
-    void send_message(const std::string& name, const std::string& message);
-    void send_private_message(const std::string& name, const std::string& message);
-};
-
-class ChatUserProfile {
-private:
-    const std::string name;
-    const std::string password;
-
-public:
-    ChatUserProfile(const std::string name, const std::string password);
-
-    bool compare_password(const std::string& password) const noexcept;
-    std::string get_name() const noexcept;
-};
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <protocol/outbound_queue.hpp>
+#include <protocol/packed_name.hpp>
+#include <string_view.hpp>
+
+class ChatUserProfile;
+class Reactor;
+
+namespace protocol {
+    class State;
+}
+
+using ChatUserID = std::size_t;
+
+class ChatUser {
+private:
+    const ChatUserID id;
+    const ChatUserProfile& profile;
+    // Connections live in a ConnectionPool slot, so the state stays put while the user is online.
+    protocol::State& protocol_state;
+    Reactor* const reactor;
+
+public:
+    ChatUser(const ChatUserProfile& profile, protocol::State& protocol_state, Reactor* const reactor, const ChatUserID id) noexcept;
+    ChatUser(ChatUser const &) = delete;
+    ChatUser(ChatUser&&) = default;
+    ChatUser& operator=(const ChatUser&) = delete;
+    ChatUser& operator=(ChatUser&&) = default;
+
+    ChatUserID get_id() const noexcept;
+    const ChatUserProfile& get_profile() const noexcept;
+    // Only to be used from the user's reactor.
+    protocol::State& get_protocol_state() const noexcept;
+    Reactor* get_reactor() const noexcept;
+};
+
+class ChatUserProfile {
+private:
+    const protocol::UserName name;
+    const std::string password;
+
+public:
+    ChatUserProfile(const protocol::UserName name, const std::string password);
+
+    bool compare_password(const StringView password) const noexcept;
+    // Refers to the profile, which is never removed once registered.
+    StringView get_name() const noexcept;
+    protocol::UserName get_packed_name() const noexcept;
+};
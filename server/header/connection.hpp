@@ -1,59 +1,159 @@
-#pragma once
-
-#include <cstddef>
-#include <utility>
-
-#include <chat_app.hpp>
-#include <socket/tcp_client_socket.hpp>
-#include <socket/tcp_server_socket.hpp>
-
-template <typename State>
-class Connection {
-private:
-    const ConnectionID id;
-    State state;
-    TCPClientSocket socket;
-
-public:
-    Connection(ChatApp& chat_app, TCPClientSocket socket, ConnectionID id) :
-        id(id),
-        state(chat_app),
-        socket(std::move(socket))
-    {
-
-    }
-
-    Connection(Connection const &) = delete;
-    Connection(Connection&&) = default;
-    Connection& operator=(const Connection&) = delete;
-    Connection& operator=(Connection&&) = default;
-
-    ConnectionID get_id() const noexcept {
-        return id;
-    }
-
-    bool handle_events(const short events)
-    {
-        if (events & POLLERR) {
-            return true;
-        }
-    
-        bool should_close = false;
-    
-        if (events & POLLRDNORM) {
-            should_close = state.read(socket);
-        } else if (events & POLLHUP) {
-            return true;
-        }
-    
-        if (events & POLLWRNORM) {
-            should_close = should_close || state.write(socket);
-        }
-    
-        return should_close;
-    }
-
-    bool is_ready_to_write() const noexcept {
-        return state.is_ready_to_write();
-    }
-};
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+#include <poll.h>
+#include <sys/uio.h>
+
+#include <arena.hpp>
+#include <chat_app.hpp>
+#include <protocol/outbound_queue.hpp>
+#include <socket/tcp_client_socket.hpp>
+#include <socket/tcp_server_socket.hpp>
+#include <timer_wheel.hpp>
+
+// Timeouts enforced by the reactor; a zero duration disables one.
+struct ConnectionTimeouts {
+    std::chrono::seconds idle;
+    std::chrono::seconds login;
+    std::chrono::seconds message;
+};
+
+template <typename State>
+class Connection {
+private:
+    using TimePoint = TimerWheel::Clock::time_point;
+
+    const ConnectionID id;
+    const ConnectionTimeouts& timeouts;
+    TimePoint connected_at;
+    TimePoint last_received_at;
+    TimePoint message_started_at;
+    bool has_received;
+    bool hung_up;
+    State state;
+    TCPClientSocket socket;
+
+public:
+    Connection(ChatApp& chat_app, Arena& arena, const ConnectionTimeouts& timeouts, const protocol::OutboundLimits& outbound_limits, TCPClientSocket socket, ConnectionID id) :
+        id(id),
+        timeouts(timeouts),
+        connected_at(TimerWheel::Clock::now()),
+        last_received_at(connected_at),
+        message_started_at(TimePoint::max()),
+        has_received(false),
+        hung_up(false),
+        state(chat_app, arena, outbound_limits),
+        socket(std::move(socket))
+    {
+
+    }
+
+    Connection(Connection const &) = delete;
+    Connection(Connection&&) = default;
+    Connection& operator=(const Connection&) = delete;
+    Connection& operator=(Connection&&) = default;
+
+    // Returns when the connection times out: after the idle timeout without receiving anything,
+    // the login timeout while unauthenticated or the message timeout while a message is only
+    // partially received. The reactor calls this after handling the connection's events, with
+    // now being the time those events were reported.
+    TimePoint get_deadline(const TimePoint now) noexcept {
+        if (has_received) {
+            last_received_at = now;
+            has_received = false;
+        }
+
+        if (!state.has_partial_message()) {
+            message_started_at = TimePoint::max();
+        } else if (message_started_at == TimePoint::max()) {
+            message_started_at = now;
+        }
+
+        auto deadline = TimePoint::max();
+
+        if (timeouts.idle.count() > 0) {
+            deadline = std::min(deadline, last_received_at + timeouts.idle);
+        }
+
+        if (timeouts.login.count() > 0 && !state.is_authenticated()) {
+            deadline = std::min(deadline, connected_at + timeouts.login);
+        }
+
+        if (timeouts.message.count() > 0 && message_started_at != TimePoint::max()) {
+            deadline = std::min(deadline, message_started_at + timeouts.message);
+        }
+
+        return deadline;
+    }
+
+    int get_fd() const noexcept {
+        return socket.get_fd();
+    }
+
+    ConnectionID get_id() const noexcept {
+        return id;
+    }
+
+    bool handle_events(const short events)
+    {
+        // Completions of zero-copy sends are reported on the error queue, which polls as an error.
+        if ((events & POLLERR) && !state.reap_zero_copy_completions(socket)) {
+            return true;
+        }
+    
+        if ((events & POLLRDNORM) && !hung_up) {
+            has_received = true;
+            // A short read ends State::read before it sees the end of the stream, so a hang up
+            // reported together with data is handled once the data has been read.
+            hung_up = state.read(socket) || (events & POLLHUP);
+        } else if (events & POLLHUP) {
+            hung_up = true;
+        }
+    
+        if (((events & POLLWRNORM) || hung_up) && state.write(socket)) {
+            return true;
+        }
+    
+        // The peer may only have shut down its sending side and still be waiting for the
+        // responses to what it sent, so the connection is closed once they have been written.
+        return hung_up && !state.is_ready_to_write();
+    }
+
+    void handle_hang_up() noexcept {
+        hung_up = true;
+    }
+
+    bool handle_received(const unsigned char* const data, const std::size_t size) {
+        has_received = true;
+        return state.receive(data, size);
+    }
+
+    void handle_sent(const std::size_t size) noexcept {
+        state.handle_sent(size);
+    }
+
+    bool is_hung_up() const noexcept {
+        return hung_up;
+    }
+
+    bool is_ready_to_write() const noexcept {
+        return state.is_ready_to_write();
+    }
+
+    bool is_slow_consumer() const noexcept {
+        return state.is_slow_consumer();
+    }
+
+    std::size_t peek_write(iovec* const vectors, const std::size_t max_vectors) noexcept {
+        return state.peek_write(vectors, max_vectors);
+    }
+
+    template <typename WritePendingHandler>
+    void set_write_pending_handler(WritePendingHandler&& write_pending_handler) {
+        state.set_write_pending_handler(std::forward<WritePendingHandler>(write_pending_handler));
+    }
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <buffer_pool.hpp>
+#include <protocol/write_buffer.hpp>
+#include <socket/tcp_client_socket.hpp>
+#include <string_view.hpp>
+
+namespace protocol {
+    // Frames take their memory from the buffer pool of the thread building them.
+    using Frame = std::basic_string<char, std::char_traits<char>, BufferPoolAllocator<char>>;
+    // Encoded frame that is never modified once built, so one copy can be queued for any number
+    // of connections on any reactor.
+    using SharedFrame = std::shared_ptr<const Frame>;
+
+    inline SharedFrame make_shared_frame(Frame frame) {
+        return std::allocate_shared<Frame>(BufferPoolAllocator<Frame>(), std::move(frame));
+    }
+
+    // What happens to events for a connection whose unsent output has reached the high watermark,
+    // until it has drained to the low watermark again. Responses to the connection's own
+    // requests are never dropped.
+    enum class SlowConsumerPolicy {
+        // Only the latest event is kept and sent once the connection has caught up.
+        Coalesce,
+        Disconnect,
+        // The oldest queued events are dropped to make room for new ones.
+        DropOldest
+    };
+
+    struct OutboundLimits {
+        std::size_t high_watermark;
+        std::size_t low_watermark;
+        SlowConsumerPolicy policy;
+        // Queued frames of at least this size are sent with MSG_ZEROCOPY; 0 disables it.
+        std::size_t zero_copy_threshold;
+    };
+
+    // Process wide counts of how often the slow consumer policies fired.
+    struct SlowConsumerCounters {
+        std::atomic<std::uint64_t> high_watermarks_reached;
+        std::atomic<std::uint64_t> events_coalesced;
+        std::atomic<std::uint64_t> events_dropped;
+        std::atomic<std::uint64_t> disconnects;
+    };
+
+    // Output of a connection. Small frames are copied into the write buffer while nothing is
+    // queued behind it; larger ones, and everything once the buffer is behind, are queued as
+    // references to the frames, and both are gathered into a single writev (or io_uring send).
+    // Frames are only ever dropped whole, so a slow reader cannot make a push fail or corrupt the
+    // stream, and one that falls too far behind is handled by the configured policy.
+    class OutboundQueue {
+    private:
+        static constexpr std::size_t buffer_size = 8192;
+        static constexpr std::size_t max_copied_frame_size = 512;
+        static constexpr std::size_t max_socket_vectors = 64;
+
+        enum class ZeroCopy {
+            Untried,
+            Enabled,
+            Unsupported
+        };
+
+        struct Entry {
+            SharedFrame frame;
+            bool is_event;
+        };
+
+        struct PinnedFrame {
+            std::uint32_t send;
+            SharedFrame frame;
+        };
+
+        static SlowConsumerCounters counters;
+
+        const OutboundLimits& limits;
+        // Everything in the buffer is older than the queued frames.
+        WriteBuffer<buffer_size> buffer;
+        // Queued frames start at entries[front]; the ones before it have been sent and are erased
+        // in bulk.
+        std::vector<Entry> entries;
+        std::size_t front;
+        // Bytes of the front frame already sent.
+        std::size_t front_offset;
+        // Entries handed out by the last peek, which an asynchronous send may still reference
+        // until consume is called, so they are never dropped.
+        std::size_t peeked_entries;
+        std::size_t queued_size;
+        SharedFrame coalesced_event;
+        // Frames sent with MSG_ZEROCOPY are kept until the kernel reports their sends complete,
+        // as it reads them in place. Frames still pinned when the connection is closed are
+        // released with it.
+        std::vector<PinnedFrame> pinned_frames;
+        std::uint32_t zero_copy_sends;
+        ZeroCopy zero_copy;
+        bool is_behind;
+        bool is_disconnecting;
+
+        bool disconnect() noexcept;
+        bool drop_oldest_event();
+        void enqueue(const SharedFrame& frame, const bool is_event);
+        bool is_zero_copy_entry(const std::size_t index) const noexcept;
+        bool try_copy(const StringView frame);
+        bool try_send_zero_copy(TCPClientSocket& socket, const iovec* const vectors, const std::size_t count, IoResult& result);
+
+    public:
+        OutboundQueue(const OutboundLimits& limits) noexcept;
+
+        static const SlowConsumerCounters& get_counters() noexcept;
+
+        void consume(std::size_t size);
+        // Returns the number of unsent bytes.
+        std::size_t get_size() const noexcept;
+        bool is_empty() const noexcept;
+        bool is_slow_consumer() const noexcept;
+        // Fills in up to max_vectors vectors of unsent bytes and returns how many.
+        std::size_t peek(iovec* const vectors, const std::size_t max_vectors) noexcept;
+        // Returns whether the connection has just become a slow consumer to be disconnected.
+        bool push_event(const SharedFrame& frame);
+        bool push_response(const StringView frame);
+        // Releases the frames of completed zero-copy sends; returns false if none had completed.
+        bool reap_zero_copy_completions(TCPClientSocket& socket);
+        // Sends one run of the output, all copied or all zero-copy.
+        IoResult write_to_socket(TCPClientSocket& socket);
+    };
+}
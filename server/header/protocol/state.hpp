@@ -1,60 +1,89 @@
-#pragma once
-
-#include <array>
-#include <cstddef>
-#include <exception>
-
-#include <chat_app.hpp>
-#include <chat_user.hpp>
-#include <socket/tcp_client_socket.hpp>
-
-#include <protocol/message.hpp>
-#include <protocol/read_buffer.hpp>
-#include <protocol/write_buffer.hpp>
-
-namespace protocol {
-    class State {
-    private:
-        static constexpr std::size_t read_buffer_size = 8192;
-        static constexpr std::size_t write_buffer_size = 8192;
-
-        ChatApp& chat_app;
-        ChatUserID chat_user_id;
-        ClientMessageType client_message_type;
-        ReadBuffer<read_buffer_size> read_buffer;
-        ReadState read_state;
-        WriteBuffer<write_buffer_size> write_buffer;
-
-        void reset_read_state();
-
-        void parse_message();
-        void parse_list_users_message();
-        void parse_login_message();
-        void parse_logout_message();
-        void parse_register_message();
-        void parse_send_private_message_message();
-        void parse_send_public_message_message();
-
-        void send_header_error_response_message(const HeaderErrorCode error_code);
-        void send_list_users_response_message(const ListUsersResponseCode response_code);
-        void send_list_users_response_message(const vector<string>& users_list);
-        void send_login_response_message(const LoginResponseCode response_code);
-        void send_logout_response_message(const LogoutResponseCode response_code);
-        void send_register_response_message(const RegisterResponseCode response_code);
-        void send_send_private_message_response_message(const SendPrivateMessageResponseCode response_code);
-        void send_send_public_message_response_message(const SendPublicMessageResponseCode response_code);
-
-    public:
-        State(ChatApp& chat_app) noexcept;
-        ~State();
-
-        bool is_ready_to_write() const noexcept;
-        bool read(TCPClientSocket& socket);
-        bool write(TCPClientSocket& socket);
-
-        void send_send_private_message_event_message(const std::string& message);
-        void send_send_private_message_event_message(const std::string& name, const std::string& message);
-        void send_send_public_message_event_message(const std::string& message);
-        void send_send_public_message_event_message(const std::string& name, const std::string& message);
-    };
-}
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <functional>
+
+#include <arena.hpp>
+#include <chat_app.hpp>
+#include <chat_user.hpp>
+#include <socket/tcp_client_socket.hpp>
+#include <string_view.hpp>
+
+#include <protocol/message.hpp>
+#include <protocol/outbound_queue.hpp>
+#include <protocol/read_buffer.hpp>
+
+namespace protocol {
+    class State {
+    private:
+        static constexpr std::size_t read_buffer_size = 8192;
+
+        ChatApp& chat_app;
+        // Shared by every connection of the reactor, and reset after each message, so everything
+        // allocated from it while handling one is gone once it has been handled.
+        Arena& arena;
+        ChatUserID chat_user_id;
+        ClientMessageType client_message_type;
+        ReadBuffer<read_buffer_size> read_buffer;
+        ReadState read_state;
+        OutboundQueue outbound_queue;
+        std::function<void()> write_pending_handler;
+
+        void process_read_buffer();
+        void push_response(const StringView frame);
+        void reset_read_state();
+
+        void parse_message();
+        void parse_list_users_message();
+        void parse_login_message();
+        void parse_logout_message();
+        void parse_register_message();
+        void parse_send_private_message_message();
+        void parse_send_public_message_message();
+
+        void send_header_error_response_message(const HeaderErrorCode error_code);
+        void send_list_users_response_message(const ListUsersResponseCode response_code);
+        void send_list_users_response_message(const ArenaVector<StringView>& users_list);
+        void send_login_response_message(const LoginResponseCode response_code);
+        void send_logout_response_message(const LogoutResponseCode response_code);
+        void send_register_response_message(const RegisterResponseCode response_code);
+        void send_response_message(const ServerMessageType message_type, const unsigned char response_code);
+        void send_send_private_message_response_message(const SendPrivateMessageResponseCode response_code);
+        void send_send_public_message_response_message(const SendPublicMessageResponseCode response_code);
+
+    public:
+        State(ChatApp& chat_app, Arena& arena, const OutboundLimits& outbound_limits) noexcept;
+        State(const State&) = delete;
+        State(State&& other);
+        ~State();
+        State& operator=(const State&) = delete;
+        State& operator=(State&&) = delete;
+
+        void handle_sent(const std::size_t size) noexcept;
+        bool has_partial_message() const noexcept;
+        bool is_authenticated() const noexcept;
+        bool is_ready_to_write() const noexcept;
+        // Returns whether the connection fell too far behind on its output and has to be closed.
+        bool is_slow_consumer() const noexcept;
+        // Fills in up to max_vectors vectors of pending output and returns how many; the output
+        // stays queued until handle_sent.
+        std::size_t peek_write(iovec* const vectors, const std::size_t max_vectors) noexcept;
+        bool read(TCPClientSocket& socket);
+        // Returns false if no zero-copy sends had completed, in which case the error the socket
+        // was polled for is a real one.
+        bool reap_zero_copy_completions(TCPClientSocket& socket);
+        bool receive(const unsigned char* data, std::size_t size);
+        bool write(TCPClientSocket& socket);
+        void set_write_pending_handler(std::function<void()> write_pending_handler);
+
+        // Events are encoded once and the same frame is queued for every recipient.
+        static SharedFrame make_send_private_message_event_message(const StringView message);
+        static SharedFrame make_send_private_message_event_message(const StringView name, const StringView message);
+        static SharedFrame make_send_public_message_event_message(const StringView message);
+        static SharedFrame make_send_public_message_event_message(const StringView name, const StringView message);
+
+        void send_event(const SharedFrame& frame);
+    };
+}
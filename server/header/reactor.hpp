@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <arena.hpp>
+#include <chat_app.hpp>
+#include <connection.hpp>
+#include <protocol/state.hpp>
+#include <server_config.hpp>
+#include <socket/listener_socket.hpp>
+#include <socket/tcp_server_socket.hpp>
+
+// Event loop owning its listening sockets and the connections accepted on them. Every reactor runs
+// on its own thread; other threads only interact with it by posting tasks or stopping it, both of
+// which wake it through its eventfd, so it can block in poll while idle.
+class Reactor {
+private:
+    static thread_local Reactor* current;
+
+    ChatApp& chat_app;
+    // Scratch memory for handling one message at a time, shared by all connections.
+    Arena arena;
+    const ConnectionTimeouts connection_timeouts;
+    protocol::OutboundLimits outbound_limits;
+    const std::chrono::seconds shutdown_timeout;
+    std::atomic<bool> is_stopping;
+    TCPServerSocket<Connection<protocol::State>> server_socket;
+    std::mutex tasks_mutex;
+    std::vector<std::function<void()>> tasks;
+
+    void poll(const int timeout);
+    void run_tasks();
+
+public:
+    // Listens on the configured hosts and port and, if given, on a duplicate of the Unix domain
+    // socket shared by all reactors.
+    Reactor(ChatApp& chat_app, const ServerConfig& config, const ListenerSocket* const unix_listener);
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    static Reactor* get_current() noexcept;
+
+    std::vector<std::string> get_listener_names() const;
+    void post(std::function<void()> task);
+
+    // Runs until stop is called, then stops accepting connections and keeps serving the open ones
+    // until their pending output has been written or the shutdown timeout has passed.
+    void run();
+    void stop() noexcept;
+};
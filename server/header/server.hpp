@@ -1,24 +1,25 @@
-#pragma once
-
-#include <string>
-
-#include <chat_app.hpp>
-#include <connection.hpp>
-#include <protocol/state.hpp>
-#include <socket/tcp_server_socket.hpp>
-
-class Server {
-private:
-    static constexpr std::size_t max_connections = 64;
-    static constexpr int max_pending_connections = 16;
-
-    ChatApp chat_app;
-    TCPServerSocket<Connection<protocol::State>> server_socket;
-
-public:
-    Server(const std::string port);
-    Server(const Server&) = delete;
-    Server& operator=(const Server&) = delete;
-
-    void run();
-};
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <chat_app.hpp>
+#include <reactor.hpp>
+#include <server_config.hpp>
+#include <socket/listener_socket.hpp>
+
+class Server {
+private:
+    ChatApp chat_app;
+    // Unix domain sockets cannot share a path between sockets the way SO_REUSEPORT shares a port,
+    // so the reactors accept on duplicates of this one.
+    std::unique_ptr<ListenerSocket> unix_listener;
+    std::vector<std::unique_ptr<Reactor>> reactors;
+
+public:
+    Server(const ServerConfig& config);
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    void run();
+};
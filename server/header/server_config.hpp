@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <protocol/outbound_queue.hpp>
+#include <socket/listener_socket.hpp>
+
+class InvalidServerConfigException: public std::exception {
+private:
+    const std::string what_arg;
+
+public:
+    InvalidServerConfigException(std::string what_arg) noexcept;
+
+    virtual const char* what() const noexcept override;
+};
+
+// Host address to listen on at the configured port, with the socket options of its listeners.
+struct HostConfig {
+    std::string address;
+    SocketOptions socket_options;
+};
+
+class ServerConfig {
+public:
+    std::string port;
+    std::size_t backlog;
+    // Hosts to listen on at the port, all local addresses (IPv4 and IPv6) if empty.
+    std::vector<HostConfig> hosts;
+    std::chrono::seconds idle_timeout;
+    std::chrono::seconds login_timeout;
+    std::size_t max_connections;
+    std::chrono::seconds message_timeout;
+    // Unsent output of a connection at which its slow consumer policy starts applying to events,
+    // and to which it has to drain for the policy to stop applying.
+    std::size_t outbound_high_watermark;
+    std::size_t outbound_low_watermark;
+    std::chrono::seconds shutdown_timeout;
+    // Socket options of hosts that do not set their own.
+    SocketOptions socket_options;
+    protocol::SlowConsumerPolicy slow_consumer_policy;
+    std::size_t threads;
+    // Path of a Unix domain socket to listen on in addition to the port, none if empty.
+    std::string unix_path;
+    bool use_io_uring;
+    // Frames of at least this size are sent with MSG_ZEROCOPY to TCP connections, unless it is 0
+    // or io_uring is used.
+    std::size_t zero_copy_threshold;
+
+    ServerConfig() noexcept;
+    ServerConfig(const int argc, char** argv);
+
+    static const char* get_usage() noexcept;
+};
@@ -1,129 +1,259 @@
-#include <algorithm>
-#include <cctype>
-#include <unordered_set>
-
-#include <chat_app.hpp>
-#include <protocol/state.hpp>
-
-using namespace std;
-
-const char* IncorrectPasswordException::what() const noexcept {
-    return "Incorrect password";
-}
-
-const char* UserAlreadyRegisteredException::what() const noexcept {
-    return "User already registered";
-}
-
-const char* UserDoesNotExistException::what() const noexcept {
-    return "User does not exist";
-}
-
-vector<string> ChatApp::get_online_user_list() const {
-    unordered_set<string> online_users_set;
-    vector<string> online_users_list;
-
-    for (const auto& iterator : users_online) {
-        const auto name = iterator.second.get_profile().get_name();
-
-        if (online_users_set.find(name) == online_users_set.cend()) {
-            online_users_set.emplace(name);
-            online_users_list.emplace_back(name);
-        }
-    }
-
-    return online_users_list;
-}
-
-const ChatUserProfile& ChatApp::get_user_profile(const ChatUserID user_id) const {
-    auto iterator = users_online.find(user_id);
-    
-    if (iterator == users_online.end()) {
-        throw UserDoesNotExistException();
-    }
-    
-    return iterator->second.get_profile();
-}
-
-ChatUserProfile& ChatApp::get_user_profile(std::string name) {
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    auto iterator = user_profiles.find(name);
-    
-    if (iterator == user_profiles.end()) {
-        throw UserDoesNotExistException();
-    }
-    
-    return iterator->second;
-}
-
-ChatUserID ChatApp::login(protocol::State& protocol_state, const string& name, const string& password) {
-    const auto& user_profile = get_user_profile(name);
-    
-    if (!user_profile.compare_password(password)) {
-        throw IncorrectPasswordException();
-    }
-
-    const auto user_id = ++user_sequence_number;
-    users_online.emplace(user_id, ChatUser(user_profile, protocol_state, user_id));
-    return user_id;
-}
-
-void ChatApp::logout(const ChatUserID user_id) {
-    users_online.erase(user_id);
-}
-
-void ChatApp::register_user(string name, string password) {
-    string name_lowercase = name;
-    transform(name_lowercase.begin(), name_lowercase.end(), name_lowercase.begin(), ::tolower);
-
-    if (user_profiles.find(name_lowercase) != user_profiles.cend()) {
-        throw UserAlreadyRegisteredException();
-    }
-
-    user_profiles.emplace(name_lowercase, ChatUserProfile(name, password));
-}
-
-void ChatApp::send_anonymous_message(const ChatUserID user_id, const string& message) {
-    for (auto& iterator : users_online) {
-        if (iterator.first != user_id) {
-            iterator.second.send_anonymous_message(message);
-        }
-    }
-}
-
-bool ChatApp::send_anonymous_private_message(const ChatUserID user_id, const string& name, const string& message) {
-    auto sent = false;
-
-    for (auto& iterator : users_online) {
-        if (iterator.first != user_id && iterator.second.get_profile().get_name() == name) {
-            iterator.second.send_anonymous_private_message(message);
-            sent = true;
-        }
-    }
-
-    return sent;
-}
-
-void ChatApp::send_message(const ChatUserID user_id, const string& message) {
-    const auto& user_profile = get_user_profile(user_id);
-
-    for (auto& iterator : users_online) {
-        if (iterator.first != user_id) {
-            iterator.second.send_message(user_profile.get_name(), message);
-        }
-    }
-}
-
-bool ChatApp::send_private_message(const ChatUserID user_id, const string& name, const string& message) {
-    auto sent = false;
-    const auto& user_profile = get_user_profile(user_id);
-
-    for (auto& iterator : users_online) {
-        if (iterator.first != user_id && iterator.second.get_profile().get_name() == name) {
-            iterator.second.send_private_message(user_profile.get_name(), message);
-            sent = true;
-        }
-    }
-
-    return sent;
-}
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <chat_app.hpp>
+#include <protocol/state.hpp>
+#include <reactor.hpp>
+
+using namespace std;
+
+const char* IncorrectPasswordException::what() const noexcept {
+    return "Incorrect password";
+}
+
+const char* UserAlreadyRegisteredException::what() const noexcept {
+    return "User already registered";
+}
+
+const char* UserDoesNotExistException::what() const noexcept {
+    return "User does not exist";
+}
+
+void ChatApp::collect(const ChatUser& user, Recipients& recipients) const {
+    const auto reactor = user.get_reactor();
+
+    if (reactor == Reactor::get_current()) {
+        recipients.local_states.push_back(&user.get_protocol_state());
+    } else {
+        recipients.remote_user_ids[reactor].push_back(user.get_id());
+    }
+}
+
+void ChatApp::collect_online_users(const ChatUserID user_id, Recipients& recipients) const {
+    for (const auto& iterator : users_online) {
+        if (iterator.first != user_id) {
+            collect(iterator.second, recipients);
+        }
+    }
+}
+
+bool ChatApp::collect_sessions(const ChatUserID user_id, const StringView name, Recipients& recipients) const {
+    const auto sessions = sessions_by_name.find(protocol::UserName(name));
+
+    if (sessions == sessions_by_name.end()) {
+        return false;
+    }
+
+    auto collected = false;
+
+    for (const auto session_user_id : sessions->second) {
+        if (session_user_id != user_id) {
+            collect(users_online.find(session_user_id)->second, recipients);
+            collected = true;
+        }
+    }
+
+    return collected;
+}
+
+// Called without the lock. Remote users may have logged out by the time the task runs, so it
+// collects the ones still online again.
+void ChatApp::deliver(Recipients& recipients, const protocol::SharedFrame& frame) {
+    for (const auto state : recipients.local_states) {
+        state->send_event(frame);
+    }
+
+    recipients.local_states.clear();
+
+    for (auto& iterator : recipients.remote_user_ids) {
+        if (iterator.second.empty()) {
+            continue;
+        }
+
+        const auto user_ids = move(iterator.second);
+        iterator.second.clear();
+
+        iterator.first->post([this, user_ids, frame]() {
+            auto& recipients = get_recipients();
+
+            {
+                lock_guard<std::mutex> lock(mutex);
+
+                for (const auto user_id : user_ids) {
+                    const auto user = users_online.find(user_id);
+
+                    if (user != users_online.end()) {
+                        recipients.local_states.push_back(&user->second.get_protocol_state());
+                    }
+                }
+            }
+
+            deliver(recipients, frame);
+        });
+    }
+}
+
+const ChatUserProfile& ChatApp::find_user_profile(const ChatUserID user_id) const {
+    auto iterator = users_online.find(user_id);
+    
+    if (iterator == users_online.end()) {
+        throw UserDoesNotExistException();
+    }
+    
+    return iterator->second.get_profile();
+}
+
+ChatUserProfile& ChatApp::find_user_profile(const StringView name) {
+    auto iterator = user_profiles.find(protocol::UserName(name).fold_case());
+    
+    if (iterator == user_profiles.end()) {
+        throw UserDoesNotExistException();
+    }
+    
+    return *iterator->second;
+}
+
+// Profiles are never removed, so the names stay valid after the lock is released.
+ArenaVector<StringView> ChatApp::get_online_user_list(Arena& arena) const {
+    lock_guard<std::mutex> lock(mutex);
+    ArenaVector<StringView> online_users_list(arena);
+    online_users_list.reserve(users_online.size());
+
+    for (const auto& iterator : users_online) {
+        online_users_list.emplace_back(iterator.second.get_profile().get_name());
+    }
+
+    sort(online_users_list.begin(), online_users_list.end());
+    online_users_list.erase(unique(online_users_list.begin(), online_users_list.end()), online_users_list.end());
+
+    return online_users_list;
+}
+
+const ChatUserProfile& ChatApp::get_user_profile(const ChatUserID user_id) const {
+    lock_guard<std::mutex> lock(mutex);
+    return find_user_profile(user_id);
+}
+
+ChatUserProfile& ChatApp::get_user_profile(const StringView name) {
+    lock_guard<std::mutex> lock(mutex);
+    return find_user_profile(name);
+}
+
+ChatUserID ChatApp::login(protocol::State& protocol_state, const StringView name, const StringView password) {
+    lock_guard<std::mutex> lock(mutex);
+    const auto& user_profile = find_user_profile(name);
+    
+    if (!user_profile.compare_password(password)) {
+        throw IncorrectPasswordException();
+    }
+
+    const auto user_id = ++user_sequence_number;
+    users_online.emplace(user_id, user_profile, protocol_state, Reactor::get_current(), user_id);
+    sessions_by_name[user_profile.get_packed_name()].push_back(user_id);
+    return user_id;
+}
+
+void ChatApp::logout(const ChatUserID user_id) {
+    lock_guard<std::mutex> lock(mutex);
+    auto user = users_online.find(user_id);
+
+    if (user == users_online.end()) {
+        return;
+    }
+
+    auto sessions = sessions_by_name.find(user->second.get_profile().get_packed_name());
+    auto& user_ids = sessions->second;
+    user_ids.erase(find(user_ids.begin(), user_ids.end(), user_id));
+
+    if (user_ids.empty()) {
+        sessions_by_name.erase(sessions);
+    }
+
+    users_online.erase(user);
+}
+
+void ChatApp::register_user(const StringView name, const StringView password) {
+    lock_guard<std::mutex> lock(mutex);
+    const protocol::UserName user_name(name);
+    const auto name_folded = user_name.fold_case();
+
+    if (user_profiles.find(name_folded) != user_profiles.end()) {
+        throw UserAlreadyRegisteredException();
+    }
+
+    profiles.emplace_back(user_name, password.to_string());
+    user_profiles.emplace(name_folded, &profiles.back());
+}
+
+// Every message is encoded into a single frame, which all recipients queue a reference to.
+
+void ChatApp::send_anonymous_message(const ChatUserID user_id, const StringView message) {
+    auto& recipients = get_recipients();
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        collect_online_users(user_id, recipients);
+    }
+
+    deliver(recipients, protocol::State::make_send_public_message_event_message(message));
+}
+
+bool ChatApp::send_anonymous_private_message(const ChatUserID user_id, const StringView name, const StringView message) {
+    auto& recipients = get_recipients();
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+
+        if (!collect_sessions(user_id, name, recipients)) {
+            return false;
+        }
+    }
+
+    deliver(recipients, protocol::State::make_send_private_message_event_message(message));
+    return true;
+}
+
+// The sender's profile is never removed, so its name stays valid after the lock is released.
+void ChatApp::send_message(const ChatUserID user_id, const StringView message) {
+    auto& recipients = get_recipients();
+    StringView name;
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        name = find_user_profile(user_id).get_name();
+        collect_online_users(user_id, recipients);
+    }
+
+    deliver(recipients, protocol::State::make_send_public_message_event_message(name, message));
+}
+
+bool ChatApp::send_private_message(const ChatUserID user_id, const StringView name, const StringView message) {
+    auto& recipients = get_recipients();
+    StringView sender_name;
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        sender_name = find_user_profile(user_id).get_name();
+
+        if (!collect_sessions(user_id, name, recipients)) {
+            return false;
+        }
+    }
+
+    deliver(recipients, protocol::State::make_send_private_message_event_message(sender_name, message));
+    return true;
+}
+
+// Reused by every message sent on the thread, so collecting recipients stops allocating once the
+// vectors have grown. Anything left behind by a delivery that threw is dropped.
+ChatApp::Recipients& ChatApp::get_recipients() {
+    static thread_local Recipients recipients;
+    recipients.local_states.clear();
+
+    for (auto& iterator : recipients.remote_user_ids) {
+        iterator.second.clear();
+    }
+
+    return recipients;
+}
@@ -1,23 +1,29 @@
-#include <iostream>
-
-#include <server.hpp>
-
-using namespace std;
-
-int main(int argc, char** argv) {
-    if (argc != 2) {
-        cerr << "Usage: " << argv[0] << " [port]" << endl;
-        return -1;
-    }
-
-    try {
-        Server server(argv[1]);
-        server.run();
-    } catch (const exception& error) {
-        cerr << "Server error: " << error.what() << endl;
-    } catch (...) {
-        cerr << "Unknown server error occurred." << endl;
-    }
-
-    return 0;
-}
+#include <iostream>
+
+#include <server.hpp>
+#include <server_config.hpp>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+
+    try {
+        config = ServerConfig(argc, argv);
+    } catch (const InvalidServerConfigException& error) {
+        cerr << error.what() << endl;
+        cerr << "Usage: " << argv[0] << " " << ServerConfig::get_usage() << endl;
+        return -1;
+    }
+
+    try {
+        Server server(config);
+        server.run();
+    } catch (const exception& error) {
+        cerr << "Server error: " << error.what() << endl;
+    } catch (...) {
+        cerr << "Unknown server error occurred." << endl;
+    }
+
+    return 0;
+}
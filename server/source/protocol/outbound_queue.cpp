@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <memory>
+
+#include <protocol/outbound_queue.hpp>
+
+using namespace std;
+
+namespace protocol {
+    constexpr size_t OutboundQueue::buffer_size;
+    constexpr size_t OutboundQueue::max_copied_frame_size;
+    constexpr size_t OutboundQueue::max_socket_vectors;
+
+    SlowConsumerCounters OutboundQueue::counters;
+
+    OutboundQueue::OutboundQueue(const OutboundLimits& limits) noexcept :
+        limits(limits),
+        buffer(),
+        entries(),
+        front(0),
+        front_offset(0),
+        peeked_entries(0),
+        queued_size(0),
+        coalesced_event(),
+        pinned_frames(),
+        zero_copy_sends(0),
+        zero_copy(ZeroCopy::Untried),
+        is_behind(false),
+        is_disconnecting(false)
+    {
+
+    }
+
+    const SlowConsumerCounters& OutboundQueue::get_counters() noexcept {
+        return counters;
+    }
+
+    void OutboundQueue::consume(size_t size) {
+        const auto buffered_size = min(size, buffer.get_size());
+        buffer.consume(buffered_size);
+        size -= buffered_size;
+
+        queued_size -= size;
+        peeked_entries = 0;
+
+        while (size > 0) {
+            auto& entry = entries[front];
+            const auto remaining_size = entry.frame->size() - front_offset;
+
+            if (size < remaining_size) {
+                front_offset += size;
+                break;
+            }
+
+            size -= remaining_size;
+            entry.frame.reset();
+            ++front;
+            front_offset = 0;
+        }
+
+        if (front == entries.size()) {
+            entries.clear();
+            front = 0;
+        } else if (front >= max_socket_vectors && front * 2 >= entries.size()) {
+            entries.erase(entries.begin(), entries.begin() + front);
+            front = 0;
+        }
+
+        if (is_behind && get_size() <= limits.low_watermark) {
+            is_behind = false;
+
+            if (coalesced_event) {
+                if (!try_copy(*coalesced_event)) {
+                    enqueue(coalesced_event, true);
+                }
+
+                coalesced_event.reset();
+            }
+        }
+    }
+
+    // Queued frames are kept until the connection is destroyed, since a send in flight may still
+    // reference them.
+    bool OutboundQueue::disconnect() noexcept {
+        is_disconnecting = true;
+        ++counters.disconnects;
+        coalesced_event.reset();
+
+        return true;
+    }
+
+    // Frames handed out by peek and the partially sent front frame are skipped.
+    bool OutboundQueue::drop_oldest_event() {
+        auto index = front + peeked_entries;
+
+        if (index == front && front_offset > 0) {
+            ++index;
+        }
+
+        while (index < entries.size() && !entries[index].is_event) {
+            ++index;
+        }
+
+        if (index >= entries.size()) {
+            return false;
+        }
+
+        queued_size -= entries[index].frame->size();
+        entries.erase(entries.begin() + index);
+        ++counters.events_dropped;
+
+        return true;
+    }
+
+    void OutboundQueue::enqueue(const SharedFrame& frame, const bool is_event) {
+        entries.push_back(Entry{frame, is_event});
+        queued_size += frame->size();
+    }
+
+    // Entries are counted from the front.
+    bool OutboundQueue::is_zero_copy_entry(const size_t index) const noexcept {
+        return limits.zero_copy_threshold > 0
+            && zero_copy != ZeroCopy::Unsupported
+            && entries[front + index].frame->size() >= limits.zero_copy_threshold;
+    }
+
+    size_t OutboundQueue::get_size() const noexcept {
+        return buffer.get_size() + queued_size;
+    }
+
+    bool OutboundQueue::is_empty() const noexcept {
+        return get_size() == 0;
+    }
+
+    bool OutboundQueue::is_slow_consumer() const noexcept {
+        return is_disconnecting;
+    }
+
+    size_t OutboundQueue::peek(iovec* const vectors, const size_t max_vectors) noexcept {
+        assert(max_vectors >= 2);
+
+        auto count = buffer.peek(vectors);
+        auto offset = front_offset;
+        peeked_entries = 0;
+
+        for (auto index = front; index < entries.size() && count < max_vectors; ++index) {
+            const auto& frame = *entries[index].frame;
+            vectors[count].iov_base = const_cast<char*>(frame.data()) + offset;
+            vectors[count].iov_len = frame.size() - offset;
+            offset = 0;
+            ++count;
+            ++peeked_entries;
+        }
+
+        return count;
+    }
+
+    bool OutboundQueue::push_event(const SharedFrame& frame) {
+        if (is_disconnecting) {
+            return false;
+        }
+
+        if (!is_behind && get_size() + frame->size() <= limits.high_watermark) {
+            if (!try_copy(*frame)) {
+                enqueue(frame, true);
+            }
+
+            return false;
+        }
+
+        if (!is_behind) {
+            is_behind = true;
+            ++counters.high_watermarks_reached;
+        }
+
+        switch (limits.policy) {
+            case SlowConsumerPolicy::Coalesce:
+                if (coalesced_event) {
+                    ++counters.events_coalesced;
+                }
+
+                coalesced_event = frame;
+                return false;
+
+            case SlowConsumerPolicy::Disconnect:
+                return disconnect();
+
+            case SlowConsumerPolicy::DropOldest:
+                while (get_size() + frame->size() > limits.high_watermark) {
+                    if (!drop_oldest_event()) {
+                        ++counters.events_dropped;
+                        return false;
+                    }
+                }
+
+                enqueue(frame, true);
+                return false;
+        }
+
+        return false;
+    }
+
+    // Responses are bounded by the connection's own requests, so they may go past the high
+    // watermark, but a connection that sends requests without reading the responses is
+    // disconnected once it is twice as far behind.
+    bool OutboundQueue::push_response(const StringView frame) {
+        if (is_disconnecting) {
+            return false;
+        }
+
+        if (get_size() > 2 * limits.high_watermark) {
+            return disconnect();
+        }
+
+        if (!try_copy(frame)) {
+            enqueue(make_shared_frame(Frame(frame.data(), frame.size())), false);
+        }
+
+        return false;
+    }
+
+    bool OutboundQueue::reap_zero_copy_completions(TCPClientSocket& socket) {
+        if (pinned_frames.empty()) {
+            return false;
+        }
+
+        uint32_t first;
+        uint32_t last;
+        bool copied;
+        bool has_reaped = false;
+
+        while (socket.take_zero_copy_completion(first, last, copied)) {
+            // Send numbers wrap around.
+            pinned_frames.erase(remove_if(pinned_frames.begin(), pinned_frames.end(), [=](const PinnedFrame& pinned_frame) {
+                return pinned_frame.send - first <= last - first;
+            }), pinned_frames.end());
+
+            // The kernel copies when it cannot send from the pages directly, like on loopback, which
+            // costs more than a plain send, so the connection stops using zero-copy.
+            if (copied) {
+                zero_copy = ZeroCopy::Unsupported;
+            }
+
+            has_reaped = true;
+        }
+
+        return has_reaped;
+    }
+
+    bool OutboundQueue::try_copy(const StringView frame) {
+        if (front != entries.size() || frame.size() > max_copied_frame_size || frame.size() > buffer.get_free_size()) {
+            return false;
+        }
+
+        buffer.write_bytes(reinterpret_cast<const unsigned char*>(frame.data()), frame.size());
+        return true;
+    }
+
+    // Returns false if the socket does not support zero-copy or the kernel has no memory left for
+    // it, for the vectors to be copied instead; otherwise result is the outcome of the send.
+    bool OutboundQueue::try_send_zero_copy(TCPClientSocket& socket, const iovec* const vectors, const size_t count, IoResult& result) {
+        if (zero_copy == ZeroCopy::Untried) {
+            zero_copy = socket.enable_zero_copy() ? ZeroCopy::Enabled : ZeroCopy::Unsupported;
+        }
+
+        if (zero_copy == ZeroCopy::Unsupported) {
+            return false;
+        }
+
+        result = socket.try_send_zero_copy(vectors, count);
+
+        if (result.status == IoStatus::Error && result.error == ENOBUFS) {
+            return false;
+        }
+
+        const auto size = result.bytes;
+        size_t pinned_size = 0;
+
+        for (auto index = front; pinned_size < size; ++index) {
+            const auto& frame = entries[index].frame;
+            pinned_frames.push_back(PinnedFrame{zero_copy_sends, frame});
+            pinned_size += frame->size() - (index == front ? front_offset : 0);
+        }
+
+        if (size > 0) {
+            ++zero_copy_sends;
+            consume(size);
+        }
+
+        return true;
+    }
+
+    // With zero-copy enabled, runs of large queued frames are sent with MSG_ZEROCOPY and
+    // everything else is copied by the kernel, one run per call.
+    IoResult OutboundQueue::write_to_socket(TCPClientSocket& socket) {
+        iovec vectors[max_socket_vectors];
+        auto count = peek(vectors, max_socket_vectors);
+        const auto buffered_count = count - peeked_entries;
+
+        if (buffered_count == 0 && is_zero_copy_entry(0)) {
+            size_t zero_copy_count = 1;
+
+            while (zero_copy_count < count && is_zero_copy_entry(zero_copy_count)) {
+                ++zero_copy_count;
+            }
+
+            IoResult result;
+
+            if (try_send_zero_copy(socket, vectors, zero_copy_count, result)) {
+                return result;
+            }
+
+            count = zero_copy_count;
+        } else {
+            for (auto index = buffered_count; index < count; ++index) {
+                if (is_zero_copy_entry(index - buffered_count)) {
+                    count = index;
+                    break;
+                }
+            }
+        }
+
+        const auto result = socket.try_send(vectors, count);
+        consume(result.bytes);
+
+        return result;
+    }
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <reactor.hpp>
+#include <socket/tcp_client_socket.hpp>
+
+using namespace protocol;
+using namespace std;
+
+thread_local Reactor* Reactor::current = nullptr;
+
+Reactor::Reactor(ChatApp& chat_app, const ServerConfig& config, const ListenerSocket* const unix_listener) :
+    chat_app(chat_app),
+    arena(),
+    connection_timeouts{config.idle_timeout, config.login_timeout, config.message_timeout},
+    outbound_limits{config.outbound_high_watermark, config.outbound_low_watermark, config.slow_consumer_policy, config.zero_copy_threshold},
+    shutdown_timeout(config.shutdown_timeout),
+    is_stopping(false),
+    server_socket(config.max_connections),
+    tasks_mutex(),
+    tasks()
+{
+    const vector<HostConfig> all_hosts{{"", config.socket_options}};
+
+    for (const auto& host : config.hosts.empty() ? all_hosts : config.hosts) {
+        for (auto& listener : ListenerSocket::resolve(host.address, config.port)) {
+#ifdef DEBUG
+            listener.set_reuse_address(true);
+#endif
+
+            // Every reactor binds its own listening sockets to the same port and the kernel
+            // spreads incoming connections across them.
+
+            if (config.threads > 1) {
+                listener.set_reuse_port(true);
+            }
+
+            listener.set_options(host.socket_options);
+            listener.bind();
+            listener.listen(config.backlog);
+            server_socket.add_listener(move(listener));
+        }
+    }
+
+    if (unix_listener != nullptr) {
+        server_socket.add_listener(unix_listener->duplicate());
+    }
+
+    if (config.use_io_uring) {
+        try {
+            server_socket.enable_io_uring();
+            // Sends submitted to io_uring do not use MSG_ZEROCOPY.
+            outbound_limits.zero_copy_threshold = 0;
+        } catch (const system_error& error) {
+            cerr << "Falling back from io_uring: " << error.what() << endl;
+        }
+    }
+}
+
+Reactor* Reactor::get_current() noexcept {
+    return current;
+}
+
+vector<string> Reactor::get_listener_names() const {
+    return server_socket.get_listener_names();
+}
+
+void Reactor::poll(const int timeout) {
+    server_socket.poll(timeout, [=](TCPClientSocket&& socket, const ConnectionID connection_id) {
+        return Connection<State>(chat_app, arena, connection_timeouts, outbound_limits, forward<TCPClientSocket>(socket), connection_id);
+    });
+
+    run_tasks();
+}
+
+void Reactor::post(function<void()> task) {
+    bool was_empty;
+
+    {
+        lock_guard<mutex> lock(tasks_mutex);
+        was_empty = tasks.empty();
+        tasks.emplace_back(move(task));
+    }
+
+    // The reactor takes all queued tasks at once, so only the first one since then needs to wake
+    // it up.
+    if (was_empty) {
+        server_socket.wake();
+    }
+}
+
+void Reactor::run() {
+    current = this;
+
+    while (!is_stopping.load(memory_order_acquire)) {
+        poll(-1);
+    }
+
+    server_socket.stop_listening();
+
+    const auto deadline = chrono::steady_clock::now() + shutdown_timeout;
+
+    while (server_socket.has_pending_writes()) {
+        const auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+
+        if (remaining <= 0) {
+            cerr << "Shutdown timeout reached with output still pending." << endl;
+            break;
+        }
+
+        poll(static_cast<int>(min<chrono::milliseconds::rep>(remaining, numeric_limits<int>::max())));
+    }
+}
+
+void Reactor::run_tasks() {
+    vector<function<void()>> tasks;
+
+    {
+        lock_guard<mutex> lock(tasks_mutex);
+        tasks.swap(this->tasks);
+    }
+
+    if (tasks.empty()) {
+        return;
+    }
+
+    for (const auto& task : tasks) {
+        try {
+            task();
+        } catch (const exception& error) {
+            cerr << "Reactor task failed: " << error.what() << endl;
+        }
+    }
+
+    server_socket.flush();
+}
+
+void Reactor::stop() noexcept {
+    is_stopping.store(true, memory_order_release);
+    server_socket.wake();
+}
\ No newline at end of file
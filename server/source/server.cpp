@@ -1,37 +1,124 @@
-#include <csignal>
-#include <iostream>
-#include <utility>
-
-#include <sys/socket.h>
-
-#include <server.hpp>
-#include <socket/tcp_client_socket.hpp>
-
-using namespace protocol;
-using namespace std;
-
-Server::Server(const string port) :
-    chat_app(),
-    server_socket(port, max_connections)
-{
-    signal(SIGPIPE, SIG_IGN);
-
-    server_socket.set_non_blocking(true);
-
-#ifdef DEBUG
-    server_socket.set_reuse_address(true);
-#endif
-
-    server_socket.bind();
-    server_socket.listen(max_pending_connections);
-}
-
-void Server::run() {
-    cout << "Server initialized and running on port " << server_socket.get_port() << "." << endl;
-
-    while (true) {
-        server_socket.poll(50, [=](TCPClientSocket&& socket, const ConnectionID connection_id) {
-            return Connection<State>(chat_app, forward<TCPClientSocket>(socket), connection_id);
-        });
-    }
-}
+#include <algorithm>
+#include <csignal>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <buffer_pool.hpp>
+#include <server.hpp>
+
+using namespace std;
+
+namespace {
+    // Every connection needs a file descriptor, so raise the soft limit as far as the hard limit
+    // allows. A few descriptors are kept spare for listening sockets, epoll and io_uring.
+    void raise_open_file_limit(const ServerConfig& config) {
+        const rlim_t spare_files = 64;
+        const rlim_t required_files = config.threads * config.max_connections + spare_files;
+        rlimit limit;
+
+        if (getrlimit(RLIMIT_NOFILE, &limit) == -1 || limit.rlim_cur >= required_files) {
+            return;
+        }
+
+        limit.rlim_cur = limit.rlim_max == RLIM_INFINITY ? required_files : min(required_files, limit.rlim_max);
+        setrlimit(RLIMIT_NOFILE, &limit);
+
+        if (limit.rlim_cur < required_files) {
+            cerr << "Open file limit (" << limit.rlim_cur << ") is lower than required for the maximum connections (" << required_files << ")." << endl;
+        }
+    }
+}
+
+Server::Server(const ServerConfig& config) :
+    chat_app(),
+    unix_listener(),
+    reactors()
+{
+    signal(SIGPIPE, SIG_IGN);
+    raise_open_file_limit(config);
+
+    if (!config.unix_path.empty()) {
+        unix_listener.reset(new ListenerSocket(config.unix_path));
+        unix_listener->bind();
+        unix_listener->listen(config.backlog);
+    }
+
+    for (size_t i{0}; i < config.threads; ++i) {
+        reactors.emplace_back(new Reactor(chat_app, config, unix_listener.get()));
+    }
+}
+
+void Server::run() {
+    // SIGINT and SIGTERM are blocked in every thread (the reactor threads inherit the mask) and
+    // taken with sigwait here, which then stops the reactors.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    string listener_names;
+
+    for (const auto& name : reactors.front()->get_listener_names()) {
+        listener_names += (listener_names.empty() ? "" : ", ") + name;
+    }
+
+    cout << "Server initialized and listening on " << listener_names << " with " << reactors.size() << " reactor thread(s)." << endl;
+
+    vector<thread> threads;
+
+    for (auto& reactor_pointer : reactors) {
+        auto reactor = reactor_pointer.get();
+
+        threads.emplace_back([reactor]() {
+            try {
+                reactor->run();
+            } catch (const exception& error) {
+                cerr << "Reactor error: " << error.what() << endl;
+                kill(getpid(), SIGTERM);
+            }
+        });
+    }
+
+    int signal_number;
+    sigwait(&signals, &signal_number);
+
+    cout << "Shutting down..." << endl;
+
+    for (auto& reactor : reactors) {
+        reactor->stop();
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto& counters = protocol::OutboundQueue::get_counters();
+
+    if (counters.high_watermarks_reached > 0) {
+        cout << "Slow consumers: " << counters.high_watermarks_reached << " high watermark(s) reached, "
+            << counters.events_dropped << " event(s) dropped, " << counters.events_coalesced << " event(s) coalesced, "
+            << counters.disconnects << " disconnect(s)." << endl;
+    }
+
+    const auto& buffer_pool_stats = BufferPool::get_stats();
+    string buffer_pool_high_water;
+
+    for (size_t i{0}; i < buffer_pool_stats.size(); ++i) {
+        if (buffer_pool_stats[i].high_water > 0) {
+            buffer_pool_high_water += (buffer_pool_high_water.empty() ? "" : ", ") + to_string(buffer_pool_stats[i].high_water)
+                + " x " + to_string(BufferPool::min_block_size << i) + " bytes";
+        }
+    }
+
+    if (!buffer_pool_high_water.empty()) {
+        cout << "I/O buffer pool high water: " << buffer_pool_high_water << "." << endl;
+    }
+}
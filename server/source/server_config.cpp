@@ -0,0 +1,199 @@
+#include <climits>
+#include <exception>
+#include <utility>
+
+#include <sys/socket.h>
+
+#include <server_config.hpp>
+
+using namespace std;
+
+namespace {
+    bool parse_option(const string& argument, const string& name, string& value) {
+        const auto prefix = name + "=";
+
+        if (argument.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+
+        value = argument.substr(prefix.size());
+        return true;
+    }
+
+    size_t parse_size(const string& name, const string& value, const size_t minimum) {
+        size_t size;
+        size_t end;
+
+        try {
+            size = stoul(value, &end);
+        } catch (const exception&) {
+            throw InvalidServerConfigException("Invalid value \"" + value + "\" for " + name);
+        }
+
+        if (end != value.size() || size < minimum) {
+            throw InvalidServerConfigException("Invalid value \"" + value + "\" for " + name);
+        }
+
+        return size;
+    }
+
+    int parse_int(const string& name, const string& value, const int minimum) {
+        const auto size = parse_size(name, value, static_cast<size_t>(minimum));
+
+        if (size > INT_MAX) {
+            throw InvalidServerConfigException("Invalid value \"" + value + "\" for " + name);
+        }
+
+        return static_cast<int>(size);
+    }
+
+    // Parses "name=value" into the matching field of options; returns false for other names.
+    bool parse_socket_option(const string& option, SocketOptions& options) {
+        string value;
+
+        if (parse_option(option, "busy-poll", value)) {
+            options.busy_poll = chrono::microseconds(parse_int("busy-poll", value, 0));
+        } else if (parse_option(option, "defer-accept", value)) {
+            options.defer_accept = chrono::seconds(parse_int("defer-accept", value, 0));
+        } else if (parse_option(option, "no-delay", value)) {
+            if (value != "0" && value != "1") {
+                throw InvalidServerConfigException("Invalid value \"" + value + "\" for no-delay");
+            }
+
+            options.no_delay = value == "1";
+        } else if (parse_option(option, "not-sent-lowat", value)) {
+            options.not_sent_low_water_mark = parse_int("not-sent-lowat", value, 0);
+        } else if (parse_option(option, "receive-buffer", value)) {
+            options.receive_buffer_size = parse_int("receive-buffer", value, 0);
+        } else if (parse_option(option, "send-buffer", value)) {
+            options.send_buffer_size = parse_int("send-buffer", value, 0);
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+}
+
+InvalidServerConfigException::InvalidServerConfigException(string what_arg) noexcept :
+    what_arg(what_arg)
+{
+
+}
+
+const char* InvalidServerConfigException::what() const noexcept {
+    return what_arg.c_str();
+}
+
+ServerConfig::ServerConfig() noexcept :
+    port(),
+    backlog(SOMAXCONN),
+    hosts(),
+    idle_timeout(300),
+    login_timeout(30),
+    max_connections(10000),
+    message_timeout(30),
+    outbound_high_watermark(65536),
+    outbound_low_watermark(16384),
+    shutdown_timeout(5),
+    socket_options(),
+    slow_consumer_policy(protocol::SlowConsumerPolicy::DropOldest),
+    threads(1),
+    unix_path(),
+    use_io_uring(false),
+    zero_copy_threshold(0)
+{
+
+}
+
+ServerConfig::ServerConfig(const int argc, char** argv) :
+    ServerConfig()
+{
+    if (argc < 2) {
+        throw InvalidServerConfigException("Missing port");
+    }
+
+    port = argv[1];
+
+    // Socket options given with a host override the ones given on their own, in any order, so
+    // hosts are only parsed once every other option is known.
+    vector<string> host_options;
+
+    for (int i{2}; i < argc; ++i) {
+        const string option = argv[i];
+        string value;
+
+        if (option == "--io-uring") {
+            use_io_uring = true;
+        } else if (parse_option(option, "--backlog", value)) {
+            backlog = parse_size("--backlog", value, 1);
+        } else if (parse_option(option, "--host", value)) {
+            host_options.push_back(value);
+        } else if (parse_option(option, "--idle-timeout", value)) {
+            idle_timeout = chrono::seconds(parse_size("--idle-timeout", value, 0));
+        } else if (parse_option(option, "--login-timeout", value)) {
+            login_timeout = chrono::seconds(parse_size("--login-timeout", value, 0));
+        } else if (parse_option(option, "--max-connections", value)) {
+            max_connections = parse_size("--max-connections", value, 1);
+        } else if (parse_option(option, "--message-timeout", value)) {
+            message_timeout = chrono::seconds(parse_size("--message-timeout", value, 0));
+        } else if (parse_option(option, "--outbound-high-watermark", value)) {
+            outbound_high_watermark = parse_size("--outbound-high-watermark", value, 1);
+        } else if (parse_option(option, "--outbound-low-watermark", value)) {
+            outbound_low_watermark = parse_size("--outbound-low-watermark", value, 0);
+        } else if (parse_option(option, "--shutdown-timeout", value)) {
+            shutdown_timeout = chrono::seconds(parse_size("--shutdown-timeout", value, 0));
+        } else if (parse_option(option, "--slow-consumer-policy", value)) {
+            if (value == "coalesce") {
+                slow_consumer_policy = protocol::SlowConsumerPolicy::Coalesce;
+            } else if (value == "disconnect") {
+                slow_consumer_policy = protocol::SlowConsumerPolicy::Disconnect;
+            } else if (value == "drop-oldest") {
+                slow_consumer_policy = protocol::SlowConsumerPolicy::DropOldest;
+            } else {
+                throw InvalidServerConfigException("Invalid value \"" + value + "\" for --slow-consumer-policy");
+            }
+        } else if (parse_option(option, "--threads", value)) {
+            threads = parse_size("--threads", value, 1);
+        } else if (parse_option(option, "--unix", value)) {
+            if (value.empty()) {
+                throw InvalidServerConfigException("Invalid value \"\" for --unix");
+            }
+
+            unix_path = value;
+        } else if (parse_option(option, "--zero-copy-threshold", value)) {
+            zero_copy_threshold = parse_size("--zero-copy-threshold", value, 0);
+        } else if (option.compare(0, 2, "--") != 0 || !parse_socket_option(option.substr(2), socket_options)) {
+            throw InvalidServerConfigException("Unknown option \"" + option + "\"");
+        }
+    }
+
+    if (outbound_low_watermark > outbound_high_watermark) {
+        throw InvalidServerConfigException("--outbound-low-watermark must not exceed --outbound-high-watermark");
+    }
+
+    for (const auto& host_option : host_options) {
+        HostConfig host{string(), socket_options};
+        size_t start = 0;
+        auto end = host_option.find(',');
+
+        host.address = host_option.substr(0, end);
+
+        while (end != string::npos) {
+            start = end + 1;
+            end = host_option.find(',', start);
+
+            const auto socket_option = host_option.substr(start, end == string::npos ? string::npos : end - start);
+
+            if (!parse_socket_option(socket_option, host.socket_options)) {
+                throw InvalidServerConfigException("Unknown socket option \"" + socket_option + "\" for host \"" + host.address + "\"");
+            }
+        }
+
+        hosts.push_back(move(host));
+    }
+}
+
+const char* ServerConfig::get_usage() noexcept {
+    return "[port] [--backlog=N] [--host=ADDRESS[,SOCKET_OPTION=VALUE...] (repeatable)] [--idle-timeout=SECONDS] [--io-uring] [--login-timeout=SECONDS] [--max-connections=N (per reactor)] [--message-timeout=SECONDS] [--outbound-high-watermark=BYTES (default 65536)] [--outbound-low-watermark=BYTES (default 16384)] [--shutdown-timeout=SECONDS] [--slow-consumer-policy=coalesce|disconnect|drop-oldest (default drop-oldest)] [--threads=N] [--unix=PATH] [--zero-copy-threshold=BYTES (default 0, disabled; ignored with io_uring)] [--SOCKET_OPTION=VALUE (all hosts)] (a connection timeout of 0 disables it; socket options: busy-poll=MICROSECONDS, defer-accept=SECONDS, no-delay=0|1 (default 1), not-sent-lowat=BYTES, receive-buffer=BYTES, send-buffer=BYTES, where 0 keeps the kernel default)";
+}
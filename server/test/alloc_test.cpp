@@ -0,0 +1,282 @@
+// Drives the protocol state of a few connections over socket pairs, the way a reactor does, and
+// checks that once every buffer has grown to its working size, handling messages allocates
+// nothing on the heap.
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <arena.hpp>
+#include <chat_app.hpp>
+#include <exception.hpp>
+#include <protocol/message.hpp>
+#include <protocol/outbound_queue.hpp>
+#include <protocol/state.hpp>
+#include <protocol/write_buffer.hpp>
+#include <socket/tcp_client_socket.hpp>
+
+using namespace std;
+
+namespace {
+    // Not atomic, as the test is single threaded and the counters must not allocate themselves.
+    size_t allocation_count = 0;
+}
+
+// Both are counted: operator new does not have to go through malloc, and the C library
+// allocates through malloc directly.
+
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+
+    void* malloc(size_t size) noexcept {
+        ++allocation_count;
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept {
+        ++allocation_count;
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) noexcept {
+        ++allocation_count;
+        return __libc_realloc(pointer, size);
+    }
+}
+
+void* operator new(size_t size) {
+    ++allocation_count;
+    const auto pointer = __libc_malloc(size == 0 ? 1 : size);
+
+    if (pointer == nullptr) {
+        throw bad_alloc();
+    }
+
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    free(pointer);
+}
+
+namespace {
+    constexpr size_t warm_up_rounds = 100;
+    constexpr size_t measured_rounds = 1000;
+
+    // Wraps the reactor's end of a socket pair, the way a reactor wraps an accepted socket.
+    class SocketPairEnd : public TCPClientSocket {
+    public:
+        explicit SocketPairEnd(const int fd) noexcept :
+            TCPClientSocket(fd, sockaddr_storage(), 0, true)
+        {
+
+        }
+    };
+
+    // One connection: the reactor's end of a socket pair, and the end the test talks to as the
+    // client.
+    class Session {
+    private:
+        int client_fd;
+        SocketPairEnd socket;
+        protocol::State state;
+
+        static int make_socket_pair(int& client_fd) {
+            int fds[2];
+
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) == -1) {
+                throw errno_to_system_error("Failed to create socket pair");
+            }
+
+            client_fd = fds[1];
+            return fds[0];
+        }
+
+    public:
+        Session(ChatApp& chat_app, Arena& arena, const protocol::OutboundLimits& outbound_limits) :
+            client_fd(-1),
+            socket(make_socket_pair(client_fd)),
+            state(chat_app, arena, outbound_limits)
+        {
+
+        }
+
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        ~Session() {
+            close(client_fd);
+        }
+
+        // Delivers the request to the reactor's end and has the state handle it.
+        void send(const string& request) {
+            if (::send(client_fd, request.data(), request.size(), 0) != static_cast<ssize_t>(request.size())) {
+                throw errno_to_system_error("Failed to send request");
+            }
+
+            if (state.read(socket)) {
+                throw runtime_error("Connection closed while reading");
+            }
+        }
+
+        // Writes the state's output and discards it on the client's end.
+        void flush() {
+            if (state.write(socket)) {
+                throw runtime_error("Connection closed while writing");
+            }
+
+            char buffer[4096];
+
+            while (recv(client_fd, buffer, sizeof(buffer), 0) > 0) {
+
+            }
+        }
+    };
+
+    string make_frame(const protocol::ClientMessageType message_type, const string& payload) {
+        string frame;
+        protocol::append_u8(frame, static_cast<unsigned char>(message_type));
+        protocol::append_u16(frame, payload.size());
+
+        return frame + payload;
+    }
+
+    string make_credentials(const protocol::ClientMessageType message_type, const string& name, const string& password) {
+        string payload;
+        protocol::append_u8(payload, name.size());
+        payload += name;
+        protocol::append_u8(payload, password.size());
+        payload += password;
+
+        return make_frame(message_type, payload);
+    }
+
+    string make_public_message(const bool is_anonymous, const string& message) {
+        string payload;
+        protocol::append_u8(payload, is_anonymous);
+        protocol::append_u16(payload, message.size());
+        payload += message;
+
+        return make_frame(protocol::ClientMessageType::SendPublicMessage, payload);
+    }
+
+    string make_private_message(const bool is_anonymous, const string& name, const string& message) {
+        string payload;
+        protocol::append_u8(payload, is_anonymous);
+        protocol::append_u8(payload, name.size());
+        payload += name;
+        protocol::append_u16(payload, message.size());
+        payload += message;
+
+        return make_frame(protocol::ClientMessageType::SendPrivateMessage, payload);
+    }
+
+    // Runs the exchange until every buffer it touches has grown, then counts the allocations of
+    // further rounds.
+    template <typename Exchange>
+    bool expect_no_allocations(const char* const description, Exchange&& exchange) {
+        cout.setstate(ios::badbit);
+
+        for (size_t i{0}; i < warm_up_rounds; ++i) {
+            exchange();
+        }
+
+        const auto allocations_before = allocation_count;
+
+        for (size_t i{0}; i < measured_rounds; ++i) {
+            exchange();
+        }
+
+        const auto allocations = allocation_count - allocations_before;
+        cout.clear();
+
+        cout << (allocations == 0 ? "PASS " : "FAIL ") << description << ": " << allocations << " allocations in " << measured_rounds << " rounds" << endl;
+        return allocations == 0;
+    }
+}
+
+int main() {
+    ChatApp chat_app;
+    Arena arena;
+    const protocol::OutboundLimits outbound_limits{65536, 16384, protocol::SlowConsumerPolicy::DropOldest, 0};
+
+    Session alice(chat_app, arena, outbound_limits);
+    Session bobby(chat_app, arena, outbound_limits);
+    Session bobby_again(chat_app, arena, outbound_limits);
+
+    const auto list_users = make_frame(protocol::ClientMessageType::ListUsers, string());
+    const auto login = make_credentials(protocol::ClientMessageType::Login, "bobby", "pass1");
+    const auto logout = make_frame(protocol::ClientMessageType::Logout, string());
+    const auto public_message = make_public_message(false, string(1000, 'p'));
+    const auto anonymous_public_message = make_public_message(true, string(1000, 'a'));
+    const auto private_message = make_private_message(false, "bobby", string(1000, 'd'));
+    const auto anonymous_private_message = make_private_message(true, "bobby", string(1000, 'n'));
+
+    cout.setstate(ios::badbit);
+    alice.send(make_credentials(protocol::ClientMessageType::Register, "alice", "pass1"));
+    alice.send(make_credentials(protocol::ClientMessageType::Login, "alice", "pass1"));
+    bobby.send(make_credentials(protocol::ClientMessageType::Register, "bobby", "pass1"));
+    bobby.send(login);
+    alice.flush();
+    bobby.flush();
+    cout.clear();
+
+    auto passed = true;
+
+    passed = expect_no_allocations("list users", [&]() {
+        alice.send(list_users);
+        alice.flush();
+    }) && passed;
+
+    // A user's further sessions come and go while the user stays online.
+    passed = expect_no_allocations("log in and out", [&]() {
+        bobby_again.send(login);
+        bobby_again.send(logout);
+        bobby_again.flush();
+    }) && passed;
+
+    passed = expect_no_allocations("public message", [&]() {
+        alice.send(public_message);
+        alice.flush();
+        bobby.flush();
+    }) && passed;
+
+    passed = expect_no_allocations("anonymous public message", [&]() {
+        alice.send(anonymous_public_message);
+        alice.flush();
+        bobby.flush();
+    }) && passed;
+
+    passed = expect_no_allocations("private message", [&]() {
+        alice.send(private_message);
+        alice.flush();
+        bobby.flush();
+    }) && passed;
+
+    passed = expect_no_allocations("anonymous private message", [&]() {
+        alice.send(anonymous_private_message);
+        alice.flush();
+        bobby.flush();
+    }) && passed;
+
+    // The sessions log out as they are destroyed.
+    cout.setstate(ios::badbit);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
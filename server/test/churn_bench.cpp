@@ -0,0 +1,173 @@
+// Measures the latency of short-lived connections while many idle ones are held open: each client
+// connects, asks for the user list and disconnects, and every seventh one also replaces an idle
+// connection, so that connection slots, timers and poll entries are freed and reused in a
+// scattered order. The latency is from connecting to having the response, against a reactor on
+// its own thread.
+//
+// Usage: churn_bench [io-uring], by default with the backend the server was built with
+// (make bench POLL_BACKEND=poll for poll).
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chat_app.hpp>
+#include <exception.hpp>
+#include <protocol/message.hpp>
+#include <reactor.hpp>
+#include <server_config.hpp>
+
+using namespace std;
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t idle_connection_count = 2000;
+    constexpr size_t client_count = 5000;
+    constexpr size_t clients_per_idle_replacement = 7;
+
+#ifdef USE_POLL_BACKEND
+    const char* const default_backend = "poll";
+#else
+    const char* const default_backend = "epoll";
+#endif
+
+    // Binds an ephemeral port and releases it again for the reactor to listen on.
+    string find_free_port() {
+        const auto fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address{};
+        socklen_t address_size = sizeof(address);
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (fd == -1 || ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 || getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_size) == -1) {
+            throw errno_to_system_error("Failed to find a free port");
+        }
+
+        close(fd);
+        return to_string(ntohs(address.sin_port));
+    }
+
+    int connect_to(const string& port) {
+        const auto fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<unsigned short>(stoi(port)));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (fd == -1 || connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) {
+            throw errno_to_system_error("Failed to connect");
+        }
+
+        return fd;
+    }
+
+    void receive_all(const int fd, unsigned char* const buffer, const size_t size) {
+        size_t received = 0;
+
+        while (received < size) {
+            const auto result = recv(fd, buffer + received, size - received, 0);
+
+            if (result <= 0) {
+                throw errno_to_system_error("Failed to receive the response");
+            }
+
+            received += static_cast<size_t>(result);
+        }
+    }
+
+    // Connects, asks for the user list, waits for the response and disconnects.
+    void run_client(const string& port) {
+        const unsigned char request[protocol::header_size] = { static_cast<unsigned char>(protocol::ClientMessageType::ListUsers), 0, 0 };
+        const auto fd = connect_to(port);
+
+        if (send(fd, request, sizeof(request), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(request))) {
+            throw errno_to_system_error("Failed to send the request");
+        }
+
+        unsigned char header[protocol::header_size];
+        receive_all(fd, header, sizeof(header));
+
+        vector<unsigned char> payload((header[1] << 8) | header[2]);
+        receive_all(fd, payload.data(), payload.size());
+        close(fd);
+    }
+
+    double get_percentile(const vector<double>& sorted_latencies, const double percentile) {
+        const auto index = static_cast<size_t>(percentile / 100 * (sorted_latencies.size() - 1));
+        return sorted_latencies[index];
+    }
+}
+
+int main(int argc, char** argv) {
+    ChatApp chat_app;
+    ServerConfig config;
+    config.port = find_free_port();
+    config.hosts.push_back(HostConfig{"127.0.0.1", config.socket_options});
+    // The idle connections are never logged in, and must not time out while the clients run.
+    config.idle_timeout = chrono::seconds(0);
+    config.login_timeout = chrono::seconds(0);
+    config.use_io_uring = argc > 1 && strcmp(argv[1], "io-uring") == 0;
+
+    // The reactor reports every connection.
+    cout.setstate(ios::badbit);
+
+    Reactor reactor(chat_app, config, nullptr);
+    thread reactor_thread([&reactor]() {
+        reactor.run();
+    });
+
+    vector<int> idle_fds;
+
+    for (size_t i{0}; i < idle_connection_count; ++i) {
+        idle_fds.push_back(connect_to(config.port));
+    }
+
+    vector<double> latencies;
+    latencies.reserve(client_count);
+    const auto start = Clock::now();
+
+    for (size_t i{0}; i < client_count; ++i) {
+        if (i % clients_per_idle_replacement == clients_per_idle_replacement - 1) {
+            auto& idle_fd = idle_fds[(i * 7919) % idle_fds.size()];
+            close(idle_fd);
+            idle_fd = connect_to(config.port);
+        }
+
+        const auto client_start = Clock::now();
+        run_client(config.port);
+        const chrono::duration<double, micro> latency = Clock::now() - client_start;
+        latencies.push_back(latency.count());
+    }
+
+    const chrono::duration<double> elapsed = Clock::now() - start;
+
+    for (const auto fd : idle_fds) {
+        close(fd);
+    }
+
+    reactor.stop();
+    reactor_thread.join();
+    cout.clear();
+
+    sort(latencies.begin(), latencies.end());
+
+    cout << client_count << " clients connecting, listing users and disconnecting with " << idle_connection_count << " idle connections open ("
+        << (config.use_io_uring ? "io_uring" : default_backend) << ")" << endl;
+    cout << fixed << setprecision(0) << "  p50 " << get_percentile(latencies, 50) << " us, p99 " << get_percentile(latencies, 99)
+        << " us, p99.9 " << get_percentile(latencies, 99.9) << " us, max " << latencies.back() << " us, "
+        << client_count / elapsed.count() << " clients/s" << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,276 @@
+// Measures a reactor holding 10k, 50k and 100k idle connections, and 1k to compare them with: how
+// long accepting all of them takes, and the latency of requests on one more connection while they
+// stay open. The clients run in a child process, so each side only needs a file descriptor per
+// connection, and they connect from several loopback addresses, so they do not run out of
+// ephemeral ports.
+//
+// Usage: connection_scaling_bench [io-uring]. Sizes above the file descriptor limit are skipped.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chat_app.hpp>
+#include <exception.hpp>
+#include <protocol/message.hpp>
+#include <reactor.hpp>
+#include <server_config.hpp>
+
+using namespace std;
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t request_count = 2000;
+    constexpr size_t connections_per_address = 20000;
+    // Descriptors besides the connections: standard streams, listening socket, epoll, pipes.
+    constexpr size_t spare_fds = 64;
+
+#ifdef USE_POLL_BACKEND
+    const char* const default_backend = "poll";
+#else
+    const char* const default_backend = "epoll";
+#endif
+
+    struct Results {
+        double accept_seconds;
+        double p50_microseconds;
+        double p99_microseconds;
+    };
+
+    size_t raise_fd_limit() {
+        rlimit limit;
+
+        if (getrlimit(RLIMIT_NOFILE, &limit) == -1) {
+            throw errno_to_system_error("Failed to get file descriptor limit");
+        }
+
+        limit.rlim_cur = limit.rlim_max;
+
+        if (setrlimit(RLIMIT_NOFILE, &limit) == -1) {
+            throw errno_to_system_error("Failed to raise file descriptor limit");
+        }
+
+        return limit.rlim_cur;
+    }
+
+    // Binds an ephemeral port and releases it again for the reactor to listen on.
+    string find_free_port() {
+        const auto fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address{};
+        socklen_t address_size = sizeof(address);
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (fd == -1 || ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 || getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_size) == -1) {
+            throw errno_to_system_error("Failed to find a free port");
+        }
+
+        close(fd);
+        return to_string(ntohs(address.sin_port));
+    }
+
+    // Connects from 127.0.0.(2 + source_index). The port is only picked on connect, as picking it
+    // on bind searches every port in use.
+    int connect_to(const unsigned short port, const size_t source_index) {
+        const auto fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const int bind_address_no_port = 1;
+        sockaddr_in source{};
+        source.sin_family = AF_INET;
+        source.sin_addr.s_addr = htonl(INADDR_LOOPBACK + 1 + static_cast<uint32_t>(source_index));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (fd == -1 || setsockopt(fd, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, &bind_address_no_port, sizeof(bind_address_no_port)) == -1 ||
+            ::bind(fd, reinterpret_cast<const sockaddr*>(&source), sizeof(source)) == -1 || connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) {
+            throw errno_to_system_error("Failed to connect");
+        }
+
+        return fd;
+    }
+
+    void receive_all(const int fd, unsigned char* const buffer, const size_t size) {
+        size_t received = 0;
+
+        while (received < size) {
+            const auto result = recv(fd, buffer + received, size - received, 0);
+
+            if (result <= 0) {
+                throw errno_to_system_error("Failed to receive the response");
+            }
+
+            received += static_cast<size_t>(result);
+        }
+    }
+
+    // Asks for the user list and waits for the response.
+    void list_users(const int fd) {
+        const unsigned char request[protocol::header_size] = { static_cast<unsigned char>(protocol::ClientMessageType::ListUsers), 0, 0 };
+
+        if (send(fd, request, sizeof(request), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(request))) {
+            throw errno_to_system_error("Failed to send the request");
+        }
+
+        unsigned char header[protocol::header_size];
+        receive_all(fd, header, sizeof(header));
+
+        vector<unsigned char> payload((header[1] << 8) | header[2]);
+        receive_all(fd, payload.data(), payload.size());
+    }
+
+    // The first request on a connection made after all idle ones is only answered once the
+    // reactor has accepted them, as the backlog is accepted in order.
+    Results run_clients(const unsigned short port, const size_t connection_count) {
+        vector<int> idle_fds;
+        idle_fds.reserve(connection_count);
+        const auto start = Clock::now();
+
+        for (size_t i{0}; i < connection_count; ++i) {
+            idle_fds.push_back(connect_to(port, i / connections_per_address));
+        }
+
+        const auto active_fd = connect_to(port, connection_count / connections_per_address);
+        list_users(active_fd);
+
+        Results results;
+        const chrono::duration<double> accept_time = Clock::now() - start;
+        results.accept_seconds = accept_time.count();
+
+        vector<double> latencies;
+
+        for (size_t i{0}; i < request_count; ++i) {
+            const auto request_start = Clock::now();
+            list_users(active_fd);
+            const chrono::duration<double, micro> latency = Clock::now() - request_start;
+            latencies.push_back(latency.count());
+        }
+
+        sort(latencies.begin(), latencies.end());
+        results.p50_microseconds = latencies[latencies.size() / 2];
+        results.p99_microseconds = latencies[latencies.size() * 99 / 100];
+
+        close(active_fd);
+
+        for (const auto fd : idle_fds) {
+            close(fd);
+        }
+
+        return results;
+    }
+
+    bool run(const size_t connection_count, const bool use_io_uring, Results& results) {
+        ChatApp chat_app;
+        ServerConfig config;
+        config.port = find_free_port();
+        config.hosts.push_back(HostConfig{"127.0.0.1", config.socket_options});
+        // Room for the active connection and one more, so that the maximum is never reached.
+        config.max_connections = connection_count + 2;
+        // The idle connections are never logged in and must not time out.
+        config.idle_timeout = chrono::seconds(0);
+        config.login_timeout = chrono::seconds(0);
+        config.use_io_uring = use_io_uring;
+
+        // The reactor listens before the clients are forked off, and its thread is only started
+        // after, so that the child is a copy of a single threaded process.
+        Reactor reactor(chat_app, config, nullptr);
+        int fds[2];
+
+        if (pipe2(fds, O_CLOEXEC) == -1) {
+            throw errno_to_system_error("Failed to create pipe");
+        }
+
+        const auto pid = fork();
+
+        if (pid == -1) {
+            throw errno_to_system_error("Failed to fork");
+        }
+
+        if (pid == 0) {
+            close(fds[0]);
+            char succeeded = 0;
+
+            try {
+                results = run_clients(static_cast<unsigned short>(stoi(config.port)), connection_count);
+                succeeded = 1;
+            } catch (const exception& error) {
+                cerr << "Clients failed: " << error.what() << endl;
+            }
+
+            if (write(fds[1], &succeeded, 1) != 1 || (succeeded && write(fds[1], &results, sizeof(results)) != sizeof(results))) {
+                _exit(EXIT_FAILURE);
+            }
+
+            _exit(EXIT_SUCCESS);
+        }
+
+        close(fds[1]);
+
+        thread reactor_thread([&reactor]() {
+            reactor.run();
+        });
+
+        char succeeded = 0;
+        const auto has_results = read(fds[0], &succeeded, 1) == 1 && succeeded && read(fds[0], &results, sizeof(results)) == sizeof(results);
+        close(fds[0]);
+        waitpid(pid, nullptr, 0);
+
+        reactor.stop();
+        reactor_thread.join();
+
+        return has_results;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t connection_counts[] = { 1000, 10000, 50000, 100000 };
+    const auto use_io_uring = argc > 1 && strcmp(argv[1], "io-uring") == 0;
+    const auto fd_limit = raise_fd_limit();
+
+    cout << "Idle connections to one reactor (" << (use_io_uring ? "io_uring" : default_backend) << "), "
+        << request_count << " requests on one more" << endl;
+
+    for (const auto connection_count : connection_counts) {
+        cout << setw(7) << connection_count << " connections: ";
+
+        if (connection_count + spare_fds > fd_limit) {
+            cout << "skipped, as the file descriptor limit is " << fd_limit << endl;
+            continue;
+        }
+
+        // The reactor reports every connection.
+        cout.flush();
+        cout.setstate(ios::badbit);
+
+        Results results;
+        const auto succeeded = run(connection_count, use_io_uring, results);
+        cout.clear();
+
+        if (!succeeded) {
+            cout << "failed" << endl;
+            return EXIT_FAILURE;
+        }
+
+        cout << fixed << setprecision(2) << "accepted in " << results.accept_seconds << " s ("
+            << setprecision(1) << results.accept_seconds * 1e6 / connection_count << " us each), request p50 "
+            << results.p50_microseconds << " us, p99 " << results.p99_microseconds << " us" << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
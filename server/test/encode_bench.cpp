@@ -0,0 +1,119 @@
+// Times encoding a public message event into a WriteBuffer, which is consumed whenever it fills up
+// as if it had been sent: byte by byte with write_u8 and write_u16, as frames used to be written,
+// from a payload built with append_u8 and append_u16 and written with write_frame, as a ready
+// frame copied in with write_bytes, and as the server does, with State making a shared frame that
+// is then copied in.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <protocol/message.hpp>
+#include <protocol/state.hpp>
+#include <protocol/write_buffer.hpp>
+
+using namespace std;
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t iterations = 2000000;
+
+    using Buffer = protocol::WriteBuffer<8192>;
+
+    const auto message_type = static_cast<unsigned char>(protocol::ServerMessageType::SendPublicMessageEvent);
+
+    void write_event_per_byte(Buffer& buffer, const string& name, const string& message) {
+        buffer.write_u8(message_type);
+        buffer.write_u16(name.size() + message.size() + 4);
+        buffer.write_u8(false);
+        buffer.write_u8(name.size());
+
+        for (const auto character : name) {
+            buffer.write_u8(character);
+        }
+
+        buffer.write_u16(message.size());
+
+        for (const auto character : message) {
+            buffer.write_u8(character);
+        }
+    }
+
+    void write_event_frame(Buffer& buffer, const string& name, const string& message) {
+        string payload;
+        payload.reserve(name.size() + message.size() + 4);
+        protocol::append_u8(payload, false);
+        protocol::append_u8(payload, name.size());
+        payload += name;
+        protocol::append_u16(payload, message.size());
+        payload += message;
+
+        buffer.write_frame(message_type, payload);
+    }
+
+    // Consumes the buffer whenever the next frame might not fit, so it keeps wrapping around.
+    template <typename Write>
+    void run(const char* const description, const size_t frame_size, Write&& write) {
+        Buffer buffer;
+        const auto start = Clock::now();
+
+        for (size_t i{0}; i < iterations; ++i) {
+            if (buffer.get_free_size() < frame_size) {
+                buffer.consume(buffer.get_size());
+            }
+
+            write(buffer);
+        }
+
+        const chrono::duration<double, nano> elapsed = Clock::now() - start;
+        const auto nanoseconds = elapsed.count() / iterations;
+
+        cout << "  " << left << setw(36) << description << right << fixed << setprecision(1)
+            << setw(8) << nanoseconds << " ns" << setprecision(2) << setw(8) << nanoseconds / frame_size << " ns/byte" << endl;
+    }
+}
+
+int main() {
+    const string name = "username";
+    const string messages[] = { string(10, 'm'), string(200, 'm') };
+
+    cout << "Encoding public message events, " << iterations << " times each" << endl;
+
+    for (const auto& message : messages) {
+        const auto frame_size = protocol::header_size + name.size() + message.size() + 4;
+
+        string frame;
+        protocol::append_u8(frame, message_type);
+        protocol::append_u16(frame, name.size() + message.size() + 4);
+        protocol::append_u8(frame, false);
+        protocol::append_u8(frame, name.size());
+        frame += name;
+        protocol::append_u16(frame, message.size());
+        frame += message;
+
+        cout << frame_size << " byte frame" << endl;
+
+        run("write_u8 and write_u16 per byte", frame_size, [&](Buffer& buffer) {
+            write_event_per_byte(buffer, name, message);
+        });
+
+        run("append_u8/append_u16 and write_frame", frame_size, [&](Buffer& buffer) {
+            write_event_frame(buffer, name, message);
+        });
+
+        run("write_bytes of a ready frame", frame_size, [&](Buffer& buffer) {
+            buffer.write_bytes(reinterpret_cast<const unsigned char*>(frame.data()), frame.size());
+        });
+
+        run("State frame and write_bytes", frame_size, [&](Buffer& buffer) {
+            const auto shared_frame = protocol::State::make_send_public_message_event_message(name, message);
+            buffer.write_bytes(reinterpret_cast<const unsigned char*>(shared_frame->data()), shared_frame->size());
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+// Measures how public message fan-out scales with the number of reactor threads. Every reactor
+// runs on its own thread with a share of the users logged in on it and sends its share of the
+// messages through ChatApp, so that local recipients are queued to directly and remote ones
+// through posted tasks, as in the server. Sockets are left out: each reactor consumes its users'
+// queued output in place of writing it.
+//
+// Usage: fan_out_bench [max threads], by default the number of CPUs but at least 4.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <arena.hpp>
+#include <chat_app.hpp>
+#include <protocol/outbound_queue.hpp>
+#include <protocol/state.hpp>
+#include <reactor.hpp>
+#include <server_config.hpp>
+
+using namespace std;
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t user_count = 64;
+    constexpr size_t message_count = 20000;
+    constexpr size_t message_size = 100;
+    // Local users' output is consumed after this many messages, roughly like a reactor writes
+    // after each batch of events.
+    constexpr size_t messages_per_batch = 16;
+
+    class Latch {
+    private:
+        mutex count_mutex;
+        condition_variable count_changed;
+        size_t count;
+
+    public:
+        explicit Latch(const size_t count) :
+            count(count)
+        {
+
+        }
+
+        void count_down() {
+            lock_guard<mutex> lock(count_mutex);
+
+            if (--count == 0) {
+                count_changed.notify_all();
+            }
+        }
+
+        void wait() {
+            unique_lock<mutex> lock(count_mutex);
+            count_changed.wait(lock, [this]() {
+                return count == 0;
+            });
+        }
+    };
+
+    // The users logged in on one reactor, only touched from its thread.
+    struct Share {
+        Arena arena;
+        deque<protocol::State> states;
+        vector<ChatUserID> user_ids;
+    };
+
+    // Runs the task on every reactor's thread and waits until all of them have run it.
+    template <typename Task>
+    void run_on_reactors(vector<unique_ptr<Reactor>>& reactors, Task task) {
+        Latch latch(reactors.size());
+
+        for (size_t i{0}; i < reactors.size(); ++i) {
+            reactors[i]->post([&latch, &task, i]() {
+                task(i);
+                latch.count_down();
+            });
+        }
+
+        latch.wait();
+    }
+
+    void consume_output(Share& share) {
+        iovec vectors[16];
+
+        for (auto& state : share.states) {
+            while (true) {
+                const auto count = state.peek_write(vectors, 16);
+
+                if (count == 0) {
+                    break;
+                }
+
+                size_t size = 0;
+
+                for (size_t i{0}; i < count; ++i) {
+                    size += vectors[i].iov_len;
+                }
+
+                state.handle_sent(size);
+            }
+        }
+    }
+
+    double run(const size_t thread_count) {
+        ChatApp chat_app;
+        ServerConfig config;
+        // Each reactor listens on a port of its own, which nothing connects to.
+        config.port = "0";
+        config.threads = thread_count;
+        // A reactor only consumes the events posted to it once it is done sending its own share,
+        // so they are all kept rather than running into the slow consumer policy.
+        const protocol::OutboundLimits outbound_limits{SIZE_MAX / 2, SIZE_MAX / 4, config.slow_consumer_policy, 0};
+
+        vector<unique_ptr<Reactor>> reactors;
+        vector<Share> shares(thread_count);
+        vector<thread> threads;
+
+        for (size_t i{0}; i < thread_count; ++i) {
+            reactors.emplace_back(new Reactor(chat_app, config, nullptr));
+        }
+
+        for (auto& reactor : reactors) {
+            const auto reactor_pointer = reactor.get();
+            threads.emplace_back([reactor_pointer]() {
+                reactor_pointer->run();
+            });
+        }
+
+        for (size_t i{0}; i < user_count; ++i) {
+            const auto name = "user" + to_string(i);
+            chat_app.register_user(name, name);
+        }
+
+        run_on_reactors(reactors, [&](const size_t index) {
+            auto& share = shares[index];
+
+            for (auto i = index; i < user_count; i += thread_count) {
+                const auto name = "user" + to_string(i);
+                share.states.emplace_back(chat_app, share.arena, outbound_limits);
+                share.user_ids.push_back(chat_app.login(share.states.back(), name, name));
+            }
+        });
+
+        const string message(message_size, 'm');
+        const auto start = Clock::now();
+
+        run_on_reactors(reactors, [&](const size_t index) {
+            auto& share = shares[index];
+            const auto messages = message_count / thread_count + (index < message_count % thread_count ? 1 : 0);
+
+            for (size_t i{0}; i < messages; ++i) {
+                chat_app.send_message(share.user_ids[i % share.user_ids.size()], message);
+
+                if (i % messages_per_batch == messages_per_batch - 1) {
+                    consume_output(share);
+                }
+            }
+
+            consume_output(share);
+        });
+
+        // Tasks are run in the order they were posted, so by now every delivery to a remote user
+        // has been made.
+        run_on_reactors(reactors, [&](const size_t index) {
+            consume_output(shares[index]);
+        });
+
+        const chrono::duration<double> elapsed = Clock::now() - start;
+
+        run_on_reactors(reactors, [&](const size_t index) {
+            auto& share = shares[index];
+
+            for (const auto user_id : share.user_ids) {
+                chat_app.logout(user_id);
+            }
+
+            share.states.clear();
+        });
+
+        for (auto& reactor : reactors) {
+            reactor->stop();
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        return message_count / elapsed.count();
+    }
+}
+
+int main(int argc, char** argv) {
+    const auto max_threads = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : max<size_t>(thread::hardware_concurrency(), 4);
+
+    cout << "Public messages of " << message_size << " bytes to " << user_count << " users, spread over the reactors (" << thread::hardware_concurrency() << " CPUs)" << endl;
+
+    double single_thread_rate = 0;
+
+    for (size_t thread_count{1}; thread_count <= max_threads; ++thread_count) {
+        const auto rate = run(thread_count);
+
+        if (thread_count == 1) {
+            single_thread_rate = rate;
+        }
+
+        cout << setw(2) << thread_count << " thread(s): " << fixed << setprecision(0) << setw(9) << rate << " messages/s, "
+            << setw(10) << rate * (user_count - 1) << " deliveries/s, " << setprecision(2) << rate / single_thread_rate << "x" << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
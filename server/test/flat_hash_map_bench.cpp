@@ -0,0 +1,120 @@
+// Times FlatHashMap against std::unordered_map with integer keys, like the ChatUserIDs of the
+// online users: inserting, finding present and absent keys, and erasing, at table sizes from
+// ones that fit in the cache to ones that do not.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <flat_hash_map.hpp>
+
+using namespace std;
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    // Each operation is repeated over the keys until at least this many were timed.
+    constexpr size_t min_operations = 2000000;
+
+    struct Timings {
+        double insert;
+        double find_present;
+        double find_absent;
+        double erase;
+    };
+
+    template <typename Operation>
+    double time_per_key(const vector<uint32_t>& keys, const size_t rounds, Operation&& operation) {
+        const auto start = Clock::now();
+
+        for (size_t round{0}; round < rounds; ++round) {
+            operation();
+        }
+
+        const chrono::duration<double, nano> elapsed = Clock::now() - start;
+        return elapsed.count() / (rounds * keys.size());
+    }
+
+    // The absent keys are odd and the present ones even, so that both are spread alike.
+    template <typename Map>
+    Timings run(const vector<uint32_t>& keys, const vector<uint32_t>& absent_keys) {
+        const auto rounds = max<size_t>(1, min_operations / keys.size());
+        Timings timings;
+        size_t found = 0;
+        Map map;
+
+        // Each round fills a new table, and includes freeing the previous round's.
+        timings.insert = time_per_key(keys, rounds, [&]() {
+            map = Map();
+
+            for (const auto key : keys) {
+                map.emplace(key, key);
+            }
+        });
+
+        timings.find_present = time_per_key(keys, rounds, [&]() {
+            for (const auto key : keys) {
+                found += map.find(key) != map.end();
+            }
+        });
+
+        timings.find_absent = time_per_key(absent_keys, rounds, [&]() {
+            for (const auto key : absent_keys) {
+                found += map.find(key) != map.end();
+            }
+        });
+
+        timings.erase = time_per_key(keys, 1, [&]() {
+            for (const auto key : keys) {
+                map.erase(key);
+            }
+        });
+
+        if (found != rounds * keys.size() || !map.empty()) {
+            cout << "The maps disagree on their contents" << endl;
+            exit(EXIT_FAILURE);
+        }
+
+        return timings;
+    }
+
+    void print(const char* const name, const Timings& timings) {
+        cout << "  " << left << setw(20) << name << right << fixed << setprecision(1)
+            << setw(10) << timings.insert << setw(10) << timings.find_present
+            << setw(10) << timings.find_absent << setw(10) << timings.erase << endl;
+    }
+}
+
+int main() {
+    const size_t sizes[] = { 1000, 100000, 1000000 };
+    mt19937 generator(1);
+
+    cout << "Nanoseconds per key with uint32_t keys" << endl;
+
+    for (const auto size : sizes) {
+        vector<uint32_t> keys(size);
+        vector<uint32_t> absent_keys(size);
+
+        for (size_t i{0}; i < size; ++i) {
+            keys[i] = static_cast<uint32_t>(generator()) & ~1u;
+            absent_keys[i] = static_cast<uint32_t>(generator()) | 1u;
+        }
+
+        sort(keys.begin(), keys.end());
+        keys.erase(unique(keys.begin(), keys.end()), keys.end());
+        shuffle(keys.begin(), keys.end(), generator);
+
+        cout << setw(7) << size << " entries        insert   find hit  find miss     erase" << endl;
+        print("FlatHashMap", run<FlatHashMap<uint32_t, uint32_t>>(keys, absent_keys));
+        print("std::unordered_map", run<unordered_map<uint32_t, uint32_t>>(keys, absent_keys));
+    }
+
+    return EXIT_SUCCESS;
+}
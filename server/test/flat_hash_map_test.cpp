@@ -0,0 +1,242 @@
+// Checks FlatHashMap against std::unordered_map, and that erased slots are reused, or cleared out
+// by a rehash at the same capacity, rather than growing the table. The table's arrays are the
+// only ones allocated with new[], so counting those calls shows when it rehashes and how large.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include <flat_hash_map.hpp>
+
+using namespace std;
+
+namespace {
+    size_t array_allocation_count = 0;
+    size_t largest_array_allocation = 0;
+}
+
+void* operator new[](size_t size) {
+    ++array_allocation_count;
+    largest_array_allocation = max(largest_array_allocation, size);
+    const auto pointer = malloc(size == 0 ? 1 : size);
+
+    if (pointer == nullptr) {
+        throw bad_alloc();
+    }
+
+    return pointer;
+}
+
+void operator delete[](void* pointer) noexcept {
+    free(pointer);
+}
+
+namespace {
+    // Keys below spread_keys all have the same hash, so they are put in one run of slots, where
+    // erasing leaves deleted slots rather than empty ones.
+    constexpr uint32_t spread_keys = 1000000;
+
+    struct CollidingHash {
+        size_t operator()(const uint32_t key) const noexcept {
+            return key < spread_keys ? 0 : key;
+        }
+    };
+
+    using Map = FlatHashMap<uint32_t, uint32_t>;
+    using CollidingMap = FlatHashMap<uint32_t, uint32_t, CollidingHash>;
+
+    // Deterministic, so that a failure can be reproduced.
+    class Random {
+    private:
+        uint32_t state;
+
+    public:
+        explicit Random(const uint32_t seed) noexcept :
+            state(seed)
+        {
+
+        }
+
+        uint32_t next(const uint32_t bound) noexcept {
+            state = state * 1103515245 + 12345;
+            return (state >> 8) % bound;
+        }
+    };
+
+    bool report(const char* const description, const bool passed) {
+        cout << (passed ? "PASS " : "FAIL ") << description << endl;
+        return passed;
+    }
+
+    // Every entry is found, and iterating visits each of them exactly once.
+    template <typename TMap>
+    bool has_entries(const TMap& map, const unordered_map<uint32_t, uint32_t>& expected) {
+        if (map.size() != expected.size()) {
+            return false;
+        }
+
+        for (const auto& entry : expected) {
+            const auto iterator = map.find(entry.first);
+
+            if (iterator == map.end() || iterator->second != entry.second) {
+                return false;
+            }
+        }
+
+        unordered_map<uint32_t, size_t> visits;
+
+        for (const auto& entry : map) {
+            if (expected.count(entry.first) == 0 || ++visits[entry.first] > 1) {
+                return false;
+            }
+        }
+
+        return visits.size() == expected.size();
+    }
+
+    bool test_random_operations() {
+        Map map;
+        unordered_map<uint32_t, uint32_t> expected;
+        Random random(1);
+
+        for (uint32_t i{0}; i < 200000; ++i) {
+            const auto key = random.next(4096);
+
+            switch (random.next(3)) {
+                case 0: {
+                    const auto inserted = map.emplace(key, i).second;
+
+                    if (inserted != expected.emplace(key, i).second) {
+                        return false;
+                    }
+
+                    break;
+                }
+                case 1:
+                    if (map.erase(key) != expected.erase(key)) {
+                        return false;
+                    }
+
+                    break;
+                default:
+                    if ((map.find(key) == map.end()) != (expected.find(key) == expected.end())) {
+                        return false;
+                    }
+
+                    break;
+            }
+        }
+
+        return has_entries(map, expected);
+    }
+
+    bool test_iteration_after_erase() {
+        Map map;
+        unordered_map<uint32_t, uint32_t> expected;
+
+        for (uint32_t key{0}; key < 1000; ++key) {
+            map[key] = key;
+
+            if (key % 2 == 0) {
+                expected[key] = key;
+            }
+        }
+
+        // Erasing leaves the other entries in place, so iterating can go on past an erased one.
+        for (auto iterator = map.begin(); iterator != map.end();) {
+            const auto current = iterator++;
+
+            if (current->first % 2 == 1) {
+                map.erase(current);
+            }
+        }
+
+        return has_entries(map, expected);
+    }
+
+    bool test_deleted_slot_reuse() {
+        CollidingMap map;
+        unordered_map<uint32_t, uint32_t> expected;
+        vector<uint32_t> keys;
+        uint32_t next_key = 0;
+        Random random(2);
+
+        for (; next_key < 40; ++next_key) {
+            map.emplace(next_key, next_key);
+            keys.push_back(next_key);
+        }
+
+        for (size_t i{0}; i < 20; ++i) {
+            map.erase(keys[i]);
+        }
+
+        keys.erase(keys.begin(), keys.begin() + 20);
+
+        const auto allocations_before = array_allocation_count;
+
+        for (size_t i{0}; i < 10000; ++i, ++next_key) {
+            const auto index = random.next(keys.size());
+            map.erase(keys[index]);
+            map.emplace(next_key, next_key);
+            keys[index] = next_key;
+        }
+
+        for (const auto key : keys) {
+            expected[key] = key;
+        }
+
+        return array_allocation_count == allocations_before && has_entries(map, expected);
+    }
+
+    bool test_rehash_in_place() {
+        CollidingMap map;
+        unordered_map<uint32_t, uint32_t> expected;
+        largest_array_allocation = 0;
+
+        // Fills a table of 64 slots to its maximum load of 7/8, then erases most of it, which
+        // leaves it with deleted slots and no room for growth.
+        for (uint32_t key{0}; key < 56; ++key) {
+            map.emplace(key, key);
+        }
+
+        for (uint32_t key{0}; key < 46; ++key) {
+            map.erase(key);
+        }
+
+        for (uint32_t key{46}; key < 56; ++key) {
+            expected[key] = key;
+        }
+
+        const auto allocations_before = array_allocation_count;
+        const auto largest_before = largest_array_allocation;
+        largest_array_allocation = 0;
+
+        // The first insertion into an empty slot has to rehash, which only clears out the
+        // deleted slots, as only 10 of the 64 are used.
+        for (auto key = spread_keys; array_allocation_count == allocations_before && key < spread_keys + 8; ++key) {
+            map.emplace(key, key);
+            expected[key] = key;
+        }
+
+        const auto rehashed = array_allocation_count != allocations_before;
+        const auto same_capacity = largest_array_allocation == largest_before;
+
+        return rehashed && same_capacity && has_entries(map, expected);
+    }
+}
+
+int main() {
+    auto passed = true;
+
+    passed = report("random operations match std::unordered_map", test_random_operations()) && passed;
+    passed = report("iteration after erase", test_iteration_after_erase()) && passed;
+    passed = report("deleted slots are reused without allocating", test_deleted_slot_reuse()) && passed;
+    passed = report("rehash at the same capacity", test_rehash_in_place()) && passed;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
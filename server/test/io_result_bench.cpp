@@ -0,0 +1,134 @@
+// Times the socket calls a connection makes per message when their outcome is returned as an
+// IoResult, against the same calls throwing a std::system_error for EAGAIN, as they used to, and
+// catching it in the caller. Each message is sent and received over a socket pair, followed by a
+// receive that finds the socket drained, as a reactor's read does when a message exactly fills
+// its buffer.
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <exception.hpp>
+#include <socket/tcp_client_socket.hpp>
+
+using namespace std;
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t iterations = 200000;
+    constexpr size_t message_size = 100;
+
+    // Wraps an end of a socket pair, the way a reactor wraps an accepted socket.
+    class SocketPairEnd : public TCPClientSocket {
+    public:
+        explicit SocketPairEnd(const int fd) noexcept :
+            TCPClientSocket(fd, sockaddr_storage(), 0, true)
+        {
+
+        }
+    };
+
+    // The calls as they were before IoResult, which threw for every failure.
+
+    size_t throwing_recv(const int fd, unsigned char* const buffer, const size_t size) {
+        const auto bytes_received = ::recv(fd, buffer, size, 0);
+
+        if (bytes_received == -1) {
+            throw errno_to_system_error("Failed to receive data from socket");
+        }
+
+        return static_cast<size_t>(bytes_received);
+    }
+
+    size_t throwing_send(const int fd, const unsigned char* const buffer, const size_t size) {
+        const auto bytes_sent = ::send(fd, buffer, size, MSG_NOSIGNAL);
+
+        if (bytes_sent == -1) {
+            throw errno_to_system_error("Failed to send data to socket");
+        }
+
+        return static_cast<size_t>(bytes_sent);
+    }
+
+    // Returns false once the socket is drained.
+    bool try_throwing_recv(const int fd, unsigned char* const buffer, const size_t size, size_t& bytes_received) {
+        try {
+            bytes_received = throwing_recv(fd, buffer, size);
+            return true;
+        } catch (const system_error& error) {
+            if (error.code().value() != EAGAIN && error.code().value() != EWOULDBLOCK) {
+                throw;
+            }
+
+            return false;
+        }
+    }
+
+    template <typename Message>
+    void run(const char* const description, Message&& message) {
+        const auto start = Clock::now();
+
+        for (size_t i{0}; i < iterations; ++i) {
+            if (!message()) {
+                cout << description << ": the message was not received in full" << endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        const chrono::duration<double, nano> elapsed = Clock::now() - start;
+        cout << "  " << left << setw(44) << description << right << fixed << setprecision(0) << setw(8) << elapsed.count() / iterations << " ns" << endl;
+    }
+}
+
+int main() {
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) == -1) {
+        throw errno_to_system_error("Failed to create socket pair");
+    }
+
+    SocketPairEnd sender(fds[0]);
+    SocketPairEnd receiver(fds[1]);
+    unsigned char message[message_size] = {};
+    unsigned char buffer[message_size];
+
+    cout << "Per message of " << message_size << " bytes over a Unix socket pair, " << iterations << " times" << endl;
+
+    run("recv finding the socket drained, IoResult", [&]() {
+        return receiver.try_recv(buffer, sizeof(buffer)).status == IoStatus::WouldBlock;
+    });
+
+    run("recv finding the socket drained, throwing", [&]() {
+        size_t bytes_received;
+        return !try_throwing_recv(receiver.get_fd(), buffer, sizeof(buffer), bytes_received);
+    });
+
+    run("send, recv and drained recv, IoResult", [&]() {
+        iovec vector{message, sizeof(message)};
+        const auto sent = sender.try_send(&vector, 1);
+        const auto received = receiver.try_recv(buffer, sizeof(buffer));
+        const auto drained = receiver.try_recv(buffer, sizeof(buffer));
+
+        return sent.bytes == sizeof(message) && received.bytes == sizeof(message) && drained.status == IoStatus::WouldBlock;
+    });
+
+    run("send, recv and drained recv, throwing", [&]() {
+        size_t bytes_received = 0;
+        size_t drained_bytes = 0;
+        const auto bytes_sent = throwing_send(sender.get_fd(), message, sizeof(message));
+        try_throwing_recv(receiver.get_fd(), buffer, sizeof(buffer), bytes_received);
+
+        return bytes_sent == sizeof(message) && bytes_received == sizeof(message) && !try_throwing_recv(receiver.get_fd(), buffer, sizeof(buffer), drained_bytes);
+    });
+
+    return EXIT_SUCCESS;
+}
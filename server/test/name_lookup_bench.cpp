@@ -0,0 +1,121 @@
+// Times finding a registered user by a name in any case, the way login and registration do:
+// with the name copied into a lowercased std::string key, as before user names were packed, and
+// with the packed name folded in place, in std::unordered_map and in the FlatHashMap ChatApp uses.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <flat_hash_map.hpp>
+#include <protocol/packed_name.hpp>
+#include <string_view.hpp>
+
+using namespace std;
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t user_count = 10000;
+    constexpr size_t lookup_count = 2000000;
+
+    // Names of 4 to 8 letters and digits, as registration allows.
+    vector<string> make_names(mt19937& generator) {
+        const string characters = "abcdefghijklmnopqrstuvwxyz0123456789";
+        vector<string> names;
+
+        while (names.size() < user_count) {
+            string name(4 + generator() % 5, ' ');
+
+            for (auto& character : name) {
+                character = characters[generator() % characters.size()];
+            }
+
+            names.push_back(name);
+        }
+
+        sort(names.begin(), names.end());
+        names.erase(unique(names.begin(), names.end()), names.end());
+        return names;
+    }
+
+    string to_lower(const StringView name) {
+        string result(name.data(), name.size());
+
+        for (auto& character : result) {
+            character = static_cast<char>(tolower(static_cast<unsigned char>(character)));
+        }
+
+        return result;
+    }
+
+    template <typename Find>
+    void run(const char* const name, const vector<string>& queries, Find&& find) {
+        size_t found = 0;
+        const auto start = Clock::now();
+
+        for (size_t i{0}; i < lookup_count; ++i) {
+            const auto& query = queries[i % queries.size()];
+            found += find(StringView(query));
+        }
+
+        const chrono::duration<double, nano> elapsed = Clock::now() - start;
+
+        if (found != lookup_count) {
+            cout << name << ": a registered name was not found" << endl;
+            exit(EXIT_FAILURE);
+        }
+
+        cout << left << setw(40) << name << right << fixed << setprecision(1) << setw(8) << elapsed.count() / lookup_count << " ns" << endl;
+    }
+}
+
+int main() {
+    mt19937 generator(1);
+    const auto names = make_names(generator);
+    auto queries = names;
+
+    // Users log in with their names in whichever case they like.
+    for (auto& query : queries) {
+        for (auto& character : query) {
+            if (generator() % 2 == 0) {
+                character = static_cast<char>(toupper(static_cast<unsigned char>(character)));
+            }
+        }
+    }
+
+    shuffle(queries.begin(), queries.end(), generator);
+
+    unordered_map<string, size_t> string_map;
+    unordered_map<protocol::UserName, size_t> packed_map;
+    FlatHashMap<protocol::UserName, size_t> flat_packed_map;
+
+    for (size_t i{0}; i < names.size(); ++i) {
+        string_map.emplace(names[i], i);
+        packed_map.emplace(protocol::UserName(StringView(names[i])), i);
+        flat_packed_map.emplace(protocol::UserName(StringView(names[i])), i);
+    }
+
+    cout << lookup_count << " lookups of " << names.size() << " registered names in mixed case, per lookup" << endl;
+
+    run("lowercased std::string, unordered_map", queries, [&](const StringView query) {
+        return string_map.find(to_lower(query)) != string_map.end();
+    });
+
+    run("folded UserName, unordered_map", queries, [&](const StringView query) {
+        return packed_map.find(protocol::UserName(query).fold_case()) != packed_map.end();
+    });
+
+    run("folded UserName, FlatHashMap", queries, [&](const StringView query) {
+        return flat_packed_map.find(protocol::UserName(query).fold_case()) != flat_packed_map.end();
+    });
+
+    return EXIT_SUCCESS;
+}
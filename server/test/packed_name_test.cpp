@@ -0,0 +1,144 @@
+// Checks protocol::UserName against the byte by byte operations it replaces: case folding and
+// size with every letter and digit at every position of names up to the full 8 bytes, and that
+// its hash spreads names which only differ in a few characters.
+
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+#include <protocol/packed_name.hpp>
+#include <string_view.hpp>
+
+using namespace std;
+
+namespace {
+    bool report(const char* const description, const bool passed, const size_t checks) {
+        cout << (passed ? "PASS " : "FAIL ") << description << ": " << checks << " names" << endl;
+        return passed;
+    }
+
+    string get_alnum_bytes() {
+        string bytes;
+
+        for (int byte{0}; byte < 256; ++byte) {
+            if (isalnum(byte)) {
+                bytes += static_cast<char>(byte);
+            }
+        }
+
+        return bytes;
+    }
+
+    string to_lower(string name) {
+        for (auto& character : name) {
+            character = static_cast<char>(tolower(static_cast<unsigned char>(character)));
+        }
+
+        return name;
+    }
+
+    // Calls the check with every name of each size whose bytes are filler, except for every letter
+    // and digit in turn at each position.
+    template <typename Check>
+    bool for_each_name(const string& filler, size_t& checks, Check&& check) {
+        const auto alnum_bytes = get_alnum_bytes();
+
+        for (size_t size{0}; size <= protocol::UserName::capacity; ++size) {
+            for (size_t position{0}; position < size; ++position) {
+                for (const auto character : alnum_bytes) {
+                    auto name = filler.substr(0, size);
+                    name[position] = character;
+                    ++checks;
+
+                    if (!check(name)) {
+                        cout << "Failed on \"" << name << "\"" << endl;
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool test_fold_case(const string& filler) {
+        size_t checks = 0;
+
+        const auto passed = for_each_name(filler, checks, [](const string& name) {
+            const protocol::UserName packed_name{StringView(name)};
+            const auto folded = packed_name.fold_case();
+
+            return folded.view() == StringView(to_lower(name)) && equals_ignore_case(packed_name, protocol::UserName(StringView(to_lower(name))));
+        });
+
+        return report(("fold_case with the rest \"" + filler + "\"").c_str(), passed, checks);
+    }
+
+    bool test_size(const string& filler) {
+        size_t checks = 0;
+
+        const auto passed = for_each_name(filler, checks, [](const string& name) {
+            const protocol::UserName packed_name{StringView(name)};
+
+            return packed_name.size() == name.size() && packed_name.view() == StringView(name);
+        });
+
+        return report(("size with the rest \"" + filler + "\"").c_str(), passed, checks);
+    }
+
+    // Hashes names that share a prefix and count up in their last characters, as generated names
+    // often do, and checks that they fill about as many buckets, by both the low and the high bits
+    // of the hash, as random values would.
+    bool test_hash_spread(const string& prefix) {
+        constexpr size_t name_count = 10000;
+        constexpr size_t bucket_bits = 12;
+        constexpr size_t bucket_count = size_t{1} << bucket_bits;
+        const hash<protocol::UserName> hasher;
+        unordered_set<size_t> low_buckets;
+        unordered_set<size_t> high_buckets;
+
+        for (size_t number{0}; number < name_count; ++number) {
+            auto name = prefix;
+
+            for (size_t divisor{name_count / 10}; divisor > 0; divisor /= 10) {
+                name += static_cast<char>('0' + number / divisor % 10);
+            }
+
+            const auto value = hasher(protocol::UserName(StringView(name)));
+            low_buckets.insert(value % bucket_count);
+            high_buckets.insert(value >> (sizeof(size_t) * 8 - bucket_bits));
+        }
+
+        // Random values fill m (1 - (1 - 1/m)^n) of m buckets on average.
+        const auto expected = bucket_count * (1 - pow(1 - 1.0 / bucket_count, static_cast<double>(name_count)));
+        const auto passed = low_buckets.size() >= expected * 0.95 && high_buckets.size() >= expected * 0.95;
+
+        cout << "  " << low_buckets.size() << " low and " << high_buckets.size() << " high buckets of " << bucket_count << " filled, " << static_cast<size_t>(expected) << " expected" << endl;
+        return report(("hash spread with the prefix \"" + prefix + "\"").c_str(), passed, name_count);
+    }
+}
+
+int main() {
+    auto passed = true;
+
+    // The rest of the name is lowercase, uppercase or digits, so that a change to any byte other
+    // than the one being folded would show.
+    passed = test_fold_case("abcdefgh") && passed;
+    passed = test_fold_case("ABCDEFGH") && passed;
+    passed = test_fold_case("01234567") && passed;
+    passed = test_size("zzzzzzzz") && passed;
+    passed = test_size("ZZZZZZZZ") && passed;
+    passed = test_size("99999999") && passed;
+    passed = test_hash_spread("user") && passed;
+    passed = test_hash_spread("USER") && passed;
+    passed = test_hash_spread("ab") && passed;
+    passed = test_hash_spread("u") && passed;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,220 @@
+// Counts the socket calls the protocol state makes per message when a client pipelines private
+// messages to another user, several frames per write: every frame received with one recv is
+// handled before the next, and the responses and events queued meanwhile go out gathered into
+// one writev per connection. The calls are counted by wrapping them for the whole program, while
+// the test's client ends use read and write, which are not counted.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <arena.hpp>
+#include <chat_app.hpp>
+#include <exception.hpp>
+#include <protocol/message.hpp>
+#include <protocol/outbound_queue.hpp>
+#include <protocol/state.hpp>
+#include <protocol/write_buffer.hpp>
+#include <socket/tcp_client_socket.hpp>
+
+using namespace std;
+
+namespace {
+    size_t recv_count = 0;
+    size_t send_count = 0;
+}
+
+extern "C" {
+    ssize_t recv(int fd, void* buffer, size_t size, int flags) {
+        ++recv_count;
+        return syscall(SYS_recvfrom, fd, buffer, size, flags, nullptr, nullptr);
+    }
+
+    ssize_t send(int fd, const void* buffer, size_t size, int flags) {
+        ++send_count;
+        return syscall(SYS_sendto, fd, buffer, size, flags, nullptr, 0);
+    }
+
+    ssize_t writev(int fd, const iovec* vectors, int count) {
+        ++send_count;
+        return syscall(SYS_writev, fd, vectors, count);
+    }
+
+    ssize_t sendmsg(int fd, const msghdr* message, int flags) {
+        ++send_count;
+        return syscall(SYS_sendmsg, fd, message, flags);
+    }
+}
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t message_count = 20000;
+    constexpr size_t message_size = 100;
+
+    // Wraps the reactor's end of a socket pair, the way a reactor wraps an accepted socket.
+    class SocketPairEnd : public TCPClientSocket {
+    public:
+        explicit SocketPairEnd(const int fd) noexcept :
+            TCPClientSocket(fd, sockaddr_storage(), 0, true)
+        {
+
+        }
+    };
+
+    // One connection: the reactor's end of a socket pair, and the end the test talks to as the
+    // client.
+    class Session {
+    private:
+        int client_fd;
+        SocketPairEnd socket;
+        protocol::State state;
+
+        static int make_socket_pair(int& client_fd) {
+            int fds[2];
+
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) == -1) {
+                throw errno_to_system_error("Failed to create socket pair");
+            }
+
+            client_fd = fds[1];
+            return fds[0];
+        }
+
+    public:
+        Session(ChatApp& chat_app, Arena& arena, const protocol::OutboundLimits& outbound_limits) :
+            client_fd(-1),
+            socket(make_socket_pair(client_fd)),
+            state(chat_app, arena, outbound_limits)
+        {
+
+        }
+
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        ~Session() {
+            close(client_fd);
+        }
+
+        // Writes the requests to the reactor's end and has the state handle them.
+        void send(const string& requests) {
+            if (::write(client_fd, requests.data(), requests.size()) != static_cast<ssize_t>(requests.size())) {
+                throw errno_to_system_error("Failed to send requests");
+            }
+
+            if (state.read(socket)) {
+                throw runtime_error("Connection closed while reading");
+            }
+        }
+
+        // Writes the state's output and discards it on the client's end.
+        void flush() {
+            if (state.write(socket)) {
+                throw runtime_error("Connection closed while writing");
+            }
+
+            char buffer[65536];
+
+            while (::read(client_fd, buffer, sizeof(buffer)) > 0) {
+
+            }
+        }
+    };
+
+    string make_frame(const protocol::ClientMessageType message_type, const string& payload) {
+        string frame;
+        protocol::append_u8(frame, static_cast<unsigned char>(message_type));
+        protocol::append_u16(frame, payload.size());
+
+        return frame + payload;
+    }
+
+    string make_credentials(const protocol::ClientMessageType message_type, const string& name, const string& password) {
+        string payload;
+        protocol::append_u8(payload, name.size());
+        payload += name;
+        protocol::append_u8(payload, password.size());
+        payload += password;
+
+        return make_frame(message_type, payload);
+    }
+
+    string make_private_message(const string& name, const string& message) {
+        string payload;
+        protocol::append_u8(payload, false);
+        protocol::append_u8(payload, name.size());
+        payload += name;
+        protocol::append_u16(payload, message.size());
+        payload += message;
+
+        return make_frame(protocol::ClientMessageType::SendPrivateMessage, payload);
+    }
+
+    void run(Session& sender, Session& receiver, const size_t frames_per_write) {
+        const auto frame = make_private_message("bobby", string(message_size, 'm'));
+        string requests;
+
+        for (size_t i{0}; i < frames_per_write; ++i) {
+            requests += frame;
+        }
+
+        const auto writes = message_count / frames_per_write;
+        recv_count = 0;
+        send_count = 0;
+        cout.setstate(ios::badbit);
+        const auto start = Clock::now();
+
+        for (size_t i{0}; i < writes; ++i) {
+            sender.send(requests);
+            sender.flush();
+            receiver.flush();
+        }
+
+        const chrono::duration<double> elapsed = Clock::now() - start;
+        cout.clear();
+
+        const auto messages = static_cast<double>(writes * frames_per_write);
+        cout << setw(4) << frames_per_write << " frames per write: " << fixed << setprecision(2)
+            << setw(6) << recv_count / messages << " recv and " << setw(6) << send_count / messages << " sends per message, "
+            << setprecision(0) << setw(8) << messages / elapsed.count() << " messages/s" << endl;
+    }
+}
+
+int main() {
+    ChatApp chat_app;
+    Arena arena;
+    const protocol::OutboundLimits outbound_limits{65536, 16384, protocol::SlowConsumerPolicy::DropOldest, 0};
+
+    Session alice(chat_app, arena, outbound_limits);
+    Session bobby(chat_app, arena, outbound_limits);
+
+    cout.setstate(ios::badbit);
+    alice.send(make_credentials(protocol::ClientMessageType::Register, "alice", "pass1"));
+    alice.send(make_credentials(protocol::ClientMessageType::Login, "alice", "pass1"));
+    bobby.send(make_credentials(protocol::ClientMessageType::Register, "bobby", "pass1"));
+    bobby.send(make_credentials(protocol::ClientMessageType::Login, "bobby", "pass1"));
+    alice.flush();
+    bobby.flush();
+    cout.clear();
+
+    cout << message_count << " private messages of " << message_size << " bytes; socket calls of the sender's and receiver's states" << endl;
+
+    for (const auto frames_per_write : { 1, 10, 50 }) {
+        run(alice, bobby, frames_per_write);
+    }
+
+    // The sessions log out as they are destroyed.
+    cout.setstate(ios::badbit);
+
+    return EXIT_SUCCESS;
+}
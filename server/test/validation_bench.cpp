@@ -0,0 +1,88 @@
+// Times each validation kernel, and the per-byte isprint loop they replaced, on a valid 4 KB
+// message body.
+
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <protocol/validation.hpp>
+
+using namespace std;
+
+namespace {
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t body_size = 4096;
+    constexpr size_t iterations = 20000;
+
+    size_t find_non_printable_per_byte(const char* const data, const size_t size) {
+        size_t offset = 0;
+
+        while (offset < size && isprint(static_cast<unsigned char>(data[offset]))) {
+            ++offset;
+        }
+
+        return offset;
+    }
+
+    template <typename Finder>
+    void run(const char* const name, const string& body, Finder&& finder) {
+        size_t offsets = 0;
+        const auto start = Clock::now();
+
+        for (size_t i{0}; i < iterations; ++i) {
+            offsets += finder(body.data(), body.size());
+        }
+
+        const chrono::duration<double, nano> elapsed = Clock::now() - start;
+        const auto nanoseconds = elapsed.count() / iterations;
+
+        if (offsets != iterations * body.size()) {
+            cout << name << ": the body was found invalid" << endl;
+            exit(EXIT_FAILURE);
+        }
+
+        cout << left << setw(24) << name << right << fixed << setprecision(2) << setw(10) << nanoseconds / 1000 << " us" << setw(10) << body.size() / nanoseconds << " GB/s" << endl;
+    }
+}
+
+int main() {
+    const struct {
+        protocol::ValidationKernel kernel;
+        const char* name;
+    } kernels[] = {
+        { protocol::ValidationKernel::Scalar, "scalar" },
+        { protocol::ValidationKernel::SSE2, "SSE2" },
+        { protocol::ValidationKernel::AVX2, "AVX2" }
+    };
+
+    string body(body_size, ' ');
+
+    for (size_t i{0}; i < body.size(); ++i) {
+        body[i] = static_cast<char>(0x20 + (i * 31) % 95);
+    }
+
+    cout << "Finding the first non-printable byte of a valid " << body_size << " byte message, " << iterations << " times" << endl;
+    run("per-byte isprint loop", body, find_non_printable_per_byte);
+
+    for (const auto& kernel : kernels) {
+        if (!protocol::is_supported(kernel.kernel)) {
+            cout << left << setw(24) << kernel.name << "not supported on this CPU" << endl;
+            continue;
+        }
+
+        run(kernel.name, body, [&kernel](const char* const data, const size_t size) {
+            return protocol::find_non_printable(data, size, kernel.kernel);
+        });
+    }
+
+    run("find_non_printable", body, [](const char* const data, const size_t size) {
+        return protocol::find_non_printable(data, size);
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+// Checks every validation kernel against isalnum and isprint in the "C" locale: every byte value
+// at every position of inputs up to a few vector widths long, so each kernel's vector loop and
+// scalar tail both see it.
+
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <protocol/validation.hpp>
+
+using namespace std;
+
+namespace {
+    constexpr size_t max_size = 100;
+
+    using Finder = size_t (*)(const char* const data, const size_t size, const protocol::ValidationKernel kernel);
+    using Reference = int (*)(int c);
+
+    struct Kernel {
+        protocol::ValidationKernel kernel;
+        const char* name;
+    };
+
+    size_t find_invalid_reference(const string& input, const Reference reference) {
+        for (size_t offset{0}; offset < input.size(); ++offset) {
+            if (!reference(static_cast<unsigned char>(input[offset]))) {
+                return offset;
+            }
+        }
+
+        return input.size();
+    }
+
+    // Fills the input with valid bytes that are not all alike, then puts each byte value at each
+    // position in turn; the input without an invalid byte is checked once per size.
+    bool check(const Kernel& kernel, const char* const class_name, const Finder finder, const Reference reference, const string& valid_bytes) {
+        size_t checks = 0;
+
+        for (size_t size{0}; size <= max_size; ++size) {
+            string input(size, ' ');
+
+            for (size_t i{0}; i < size; ++i) {
+                input[i] = valid_bytes[(i * 7) % valid_bytes.size()];
+            }
+
+            for (size_t position{0}; position <= size; ++position) {
+                const auto valid_byte = position < size ? input[position] : '\0';
+
+                for (int byte{0}; byte < 256; ++byte) {
+                    if (position < size) {
+                        input[position] = static_cast<char>(byte);
+                    }
+
+                    const auto expected = find_invalid_reference(input, reference);
+                    const auto offset = finder(input.data(), input.size(), kernel.kernel);
+                    ++checks;
+
+                    if (offset != expected) {
+                        cout << "FAIL " << kernel.name << " " << class_name << ": size " << size << ", byte " << byte << " at " << position << " gave offset " << offset << " instead of " << expected << endl;
+                        return false;
+                    }
+
+                    if (position == size) {
+                        break;
+                    }
+                }
+
+                if (position < size) {
+                    input[position] = valid_byte;
+                }
+            }
+        }
+
+        cout << "PASS " << kernel.name << " " << class_name << ": " << checks << " inputs" << endl;
+        return true;
+    }
+}
+
+int main() {
+    const Kernel kernels[] = {
+        { protocol::ValidationKernel::Scalar, "scalar" },
+        { protocol::ValidationKernel::SSE2, "SSE2" },
+        { protocol::ValidationKernel::AVX2, "AVX2" }
+    };
+
+    string alnum_bytes;
+    string printable_bytes;
+
+    for (int byte{0}; byte < 256; ++byte) {
+        if (isalnum(byte)) {
+            alnum_bytes += static_cast<char>(byte);
+        }
+
+        if (isprint(byte)) {
+            printable_bytes += static_cast<char>(byte);
+        }
+    }
+
+    auto passed = true;
+
+    for (const auto& kernel : kernels) {
+        if (!protocol::is_supported(kernel.kernel)) {
+            cout << "SKIP " << kernel.name << ": not supported on this CPU" << endl;
+            continue;
+        }
+
+        passed = check(kernel, "alnum", protocol::find_non_alnum, isalnum, alnum_bytes) && passed;
+        passed = check(kernel, "printable", protocol::find_non_printable, isprint, printable_bytes) && passed;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}